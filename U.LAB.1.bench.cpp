@@ -0,0 +1,288 @@
+﻿// Бенчмарк ядер турнира рыцарей (U.LAB.1.cpp)
+// Сборка: g++ -std=c++17 -O2 -pthread U.LAB.1.bench.cpp -o knights_bench
+#define KNIGHTS_NO_MAIN
+#include "U.LAB.1.cpp"
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <limits>
+
+// Силы генерируются в диапазоне [-BENCH_STRENGTH_LIMIT, BENCH_STRENGTH_LIMIT]
+const int BENCH_STRENGTH_LIMIT = 1000;
+
+/**
+ * Параметры бенчмарка
+ */
+struct BenchmarkOptions {
+    vector<size_t> knights = { 1000, 100000, 1000000 }; // Значения n для перебора
+    vector<size_t> lengths = { 4, 16, 256 };            // Значения m для перебора
+    size_t maxElements = size_t(1) << 26;               // Пропускать конфигурации с n*m больше этого
+    unsigned maxThreads = defaultThreadCount();         // Наибольшее число потоков в развёртке
+    int repeats = 5;                                    // Повторы; берётся лучшее время
+    string outputPath = "knights_bench.csv";            // Куда записать CSV
+};
+
+/**
+ * Одна строка отчёта
+ */
+struct BenchmarkResult {
+    string variant;
+    string kernel;
+    unsigned threads;
+    size_t elementBytes; // Размер элемента хранения сил в байтах
+    size_t n;
+    size_t m;
+    double seconds;
+    double efficiency; // Эффективность масштабирования относительно одного потока
+    long long checksum;
+};
+
+/**
+ * Лучшее время выполнения функции за несколько повторов
+ *
+ * @param repeats количество повторов
+ * @param run измеряемая функция; возвращает контрольную сумму, чтобы работа не была выброшена
+ * @param checksum ссылка для сохранения контрольной суммы
+ * @return возвращает лучшее время в секундах
+ */
+double measureBest(int repeats, const function<long long()>& run, long long& checksum) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+        auto start = chrono::steady_clock::now();
+        checksum = run();
+        auto finish = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double>(finish - start).count());
+    }
+    return best;
+}
+
+/**
+ * Разбор списка чисел через запятую
+ */
+vector<size_t> parseSizeList(const string& text) {
+    vector<size_t> values;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == string::npos) comma = text.size();
+        long long value = atoll(text.substr(pos, comma - pos).c_str());
+        if (value <= 0) {
+            throw invalid_argument("Error: list '" + text + "' must contain positive numbers.");
+        }
+        values.push_back(static_cast<size_t>(value));
+        pos = comma + 1;
+    }
+    return values;
+}
+
+/**
+ * Разбор аргументов бенчмарка
+ *
+ * Поддерживается: --knights N1,N2,..., --lengths M1,M2,..., --max-elements E,
+ * --threads T, --repeats R, --output PATH
+ */
+BenchmarkOptions parseBenchmarkOptions(int argc, char* argv[]) {
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            throw invalid_argument("Error: " + arg + " requires a value.");
+        }
+        string value = argv[++i];
+        if (arg == "--knights") {
+            options.knights = parseSizeList(value);
+        }
+        else if (arg == "--lengths") {
+            options.lengths = parseSizeList(value);
+        }
+        else if (arg == "--max-elements") {
+            options.maxElements = parseSizeList(value).at(0);
+        }
+        else if (arg == "--threads") {
+            options.maxThreads = static_cast<unsigned>(parseSizeList(value).at(0));
+        }
+        else if (arg == "--repeats") {
+            options.repeats = static_cast<int>(parseSizeList(value).at(0));
+        }
+        else if (arg == "--output") {
+            options.outputPath = value;
+        }
+        else {
+            throw invalid_argument("Error: unknown argument '" + arg + "'.");
+        }
+    }
+
+    return options;
+}
+
+/**
+ * Однопоточный поиск по матрице с узким типом хранения сил
+ *
+ * Значения исходной матрицы сжимаются в диапазон T делением, поэтому
+ * контрольная сумма отличается от 32-битных вариантов. Тип хранения виден
+ * в столбце element_bytes, в столбце kernel - ядро суммирования.
+ *
+ * @param knights исходная 32-битная матрица
+ * @param options параметры бенчмарка
+ * @param results вектор для добавления строк отчёта
+ */
+template <typename T>
+void benchmarkNarrowSearch(const KnightsView& knights, const BenchmarkOptions& options, vector<BenchmarkResult>& results) {
+    size_t total = knights.rows() * knights.cols();
+    int divisor = BENCH_STRENGTH_LIMIT / numeric_limits<T>::max() + 1;
+
+    BasicKnightsMatrix<T> narrow(knights.rows(), knights.cols());
+    for (size_t k = 0; k < total; k++) {
+        narrow.data()[k] = static_cast<T>(knights.data()[k] / divisor);
+    }
+
+    long long checksum = 0;
+    double seconds = measureBest(options.repeats, [&]() {
+        TournamentRanking ranking = rankTournament(narrow.view(), 1);
+        return static_cast<long long>(ranking.maxIndex) * 1000003 + ranking.minIndex;
+        }, checksum);
+    SumKernel fixed;
+    string kernel = fixedSumKernel(knights.cols(), fixed) ? fixed.name : "narrow";
+    results.push_back({ "search", kernel, 1, sizeof(T),
+        knights.rows(), knights.cols(), seconds, 1.0, checksum });
+}
+
+/**
+ * Прогон всех вариантов на одной конфигурации n x m
+ *
+ * @param knights матрица сил
+ * @param options параметры бенчмарка
+ * @param results вектор для добавления строк отчёта
+ */
+void benchmarkConfiguration(const KnightsView& knights, const BenchmarkOptions& options, vector<BenchmarkResult>& results) {
+    size_t n = knights.rows();
+    size_t m = knights.cols();
+    long long checksum = 0;
+
+    // Ядра суммирования: один проход сумм по всем рыцарям, один поток
+    vector<SumKernel> kernels = availableSumKernels();
+    SumKernel fixed;
+    bool hasFixed = fixedSumKernel(m, fixed);
+    if (hasFixed) {
+        kernels.push_back(fixed);
+    }
+    for (const SumKernel& kernel : kernels) {
+        double seconds = measureBest(options.repeats, [&]() {
+            long long total = 0;
+            for (size_t i = 0; i < n; i++) {
+                KnightRow row = knights.row(i);
+                total += kernel.sum(row.data(), row.size());
+            }
+            return total;
+            }, checksum);
+        results.push_back({ "sum", kernel.name, 1, sizeof(int), n, m, seconds, 1.0, checksum });
+    }
+
+    // Поиск и потоковый режим для m = 4, 8, 16 идут через развёрнутое ядро
+    string searchKernel = hasFixed ? fixed.name : activeSumKernel().name;
+
+    // Полный поиск max/min с развёрткой по числу потоков: степени двойки и
+    // всегда само --threads, даже если оно не степень двойки
+    unsigned maxThreads = max(1u, options.maxThreads);
+    vector<unsigned> sweep;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+        sweep.push_back(threads);
+    }
+    sweep.push_back(maxThreads);
+
+    double singleThread = 0.0;
+    for (unsigned threads : sweep) {
+        double seconds = measureBest(options.repeats, [&]() {
+            TournamentRanking ranking = rankTournament(knights, threads);
+            return static_cast<long long>(ranking.maxIndex) * 1000003 + ranking.minIndex;
+            }, checksum);
+        if (threads == 1) {
+            singleThread = seconds;
+        }
+        results.push_back({ "search", searchKernel, threads, sizeof(int), n, m, seconds,
+            singleThread / (seconds * threads), checksum });
+    }
+
+    // Потоковый режим поверх тех же строк
+    double seconds = measureBest(options.repeats, [&]() {
+        StreamingTournament tournament(m);
+        for (size_t i = 0; i < n; i++) {
+            tournament.addKnight(knights.row(i));
+        }
+        return static_cast<long long>(tournament.maxIndex()) * 1000003 + tournament.minIndex();
+        }, checksum);
+    results.push_back({ "stream", searchKernel, 1, sizeof(int), n, m, seconds, 1.0, checksum });
+
+    // Узкое хранение сил: те же данные, приведённые к диапазону int8/int16
+    benchmarkNarrowSearch<int16_t>(knights, options, results);
+    benchmarkNarrowSearch<int8_t>(knights, options, results);
+}
+
+/**
+ * Запись отчёта в CSV
+ *
+ * @param results строки отчёта
+ * @param path путь к файлу
+ */
+void writeBenchmarkCsv(const vector<BenchmarkResult>& results, const string& path) {
+    ofstream out(path);
+    if (!out) {
+        throw runtime_error("Error: cannot create file '" + path + "'.");
+    }
+
+    out << "variant,kernel,threads,element_bytes,n,m,elements,seconds,ns_per_element,gb_per_s,scaling_efficiency,checksum\n";
+    for (const BenchmarkResult& r : results) {
+        double elements = static_cast<double>(r.n) * r.m;
+        double bytes = elements * r.elementBytes;
+        char line[512];
+        snprintf(line, sizeof(line), "%s,%s,%u,%zu,%zu,%zu,%.0f,%.9f,%.4f,%.4f,%.4f,%lld\n",
+            r.variant.c_str(), r.kernel.c_str(), r.threads, r.elementBytes, r.n, r.m, elements, r.seconds,
+            r.seconds * 1e9 / elements, bytes / r.seconds / 1e9, r.efficiency, r.checksum);
+        out << line;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    try {
+        options = parseBenchmarkOptions(argc, argv);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    mt19937 generator(20240601);
+    uniform_int_distribution<int> strength(-BENCH_STRENGTH_LIMIT, BENCH_STRENGTH_LIMIT);
+    vector<BenchmarkResult> results;
+
+    for (size_t n : options.knights) {
+        for (size_t m : options.lengths) {
+            if (n * m > options.maxElements) {
+                cerr << "Skipping n=" << n << " m=" << m << " (over --max-elements)" << endl;
+                continue;
+            }
+            cerr << "Benchmarking n=" << n << " m=" << m << endl;
+
+            KnightsMatrix knights(n, m);
+            int* data = knights.data();
+            for (size_t k = 0; k < n * m; k++) {
+                data[k] = strength(generator);
+            }
+            benchmarkConfiguration(knights.view(), options, results);
+        }
+    }
+
+    try {
+        writeBenchmarkCsv(results, options.outputPath);
+    }
+    catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    cerr << "Wrote " << results.size() << " rows to " << options.outputPath << endl;
+
+    return 0;
+}
\ No newline at end of file
@@ -1,126 +1,2795 @@
 ﻿#include <iostream>
 #include <vector>
 #include <climits>
+#include <cstddef>
+#include <cstdlib>
+#include <cctype>
+#include <string>
+#include <stdexcept>
+#include <thread>
+#include <algorithm>
+#include <charconv>
+#include <system_error>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <atomic>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define KNIGHTS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// Атрибут целевого набора инструкций для отдельных функций (GCC/Clang);
+// MSVC разрешает интринсики без него
+#if defined(__GNUC__) || defined(__clang__)
+#define KNIGHTS_TARGET(isa) __attribute__((target(isa)))
+#else
+#define KNIGHTS_TARGET(isa)
+#endif
 
 using namespace std;
 
 /**
- * Вычисление суммы элементов массива
+ * Представление массива сил одного рыцаря (строка матрицы сил)
+ *
+ * Не владеет данными: указывает на участок общей матрицы.
+ * T - тип хранения силы (int8_t, int16_t или int).
+ */
+template <typename T>
+class BasicKnightRow {
+private:
+    const T* data_;
+    size_t size_;
+
+public:
+    BasicKnightRow(const T* data, size_t size) : data_(data), size_(size) {}
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    T operator[](size_t j) const { return data_[j]; }
+};
+
+/**
+ * Представление матрицы сил рыцарей, не владеющее данными
+ *
+ * Может указывать как на KnightsMatrix, так и на отображённый в память файл.
+ */
+template <typename T>
+class BasicKnightsView {
+private:
+    const T* data_;
+    size_t rows_;
+    size_t cols_;
+
+public:
+    BasicKnightsView(const T* data, size_t n, size_t m) : data_(data), rows_(n), cols_(m) {}
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    const T* data() const { return data_; }
+
+    BasicKnightRow<T> row(size_t i) const { return BasicKnightRow<T>(data_ + i * cols_, cols_); }
+};
+
+/**
+ * Матрица сил рыцарей, хранимая построчно в одном непрерывном блоке памяти
+ *
+ * Строка i содержит массив сил рыцаря i; весь турнир занимает одно выделение памяти.
+ */
+template <typename T>
+class BasicKnightsMatrix {
+private:
+    size_t rows_;
+    size_t cols_;
+    vector<T> data_;
+
+public:
+    BasicKnightsMatrix(size_t n, size_t m) : rows_(n), cols_(m), data_(n * m) {}
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+
+    T& at(size_t i, size_t j) { return data_[i * cols_ + j]; }
+    T at(size_t i, size_t j) const { return data_[i * cols_ + j]; }
+
+    BasicKnightRow<T> row(size_t i) const { return BasicKnightRow<T>(data_.data() + i * cols_, cols_); }
+
+    T* data() { return data_.data(); }
+    const T* data() const { return data_.data(); }
+
+    BasicKnightsView<T> view() const { return BasicKnightsView<T>(data_.data(), rows_, cols_); }
+};
+
+using KnightRow = BasicKnightRow<int>;
+using KnightsView = BasicKnightsView<int>;
+using KnightsMatrix = BasicKnightsMatrix<int>;
+
+// --- Ошибки загрузки данных турнира ---
+class TournamentInputError : public runtime_error {
+public:
+    TournamentInputError(const string& msg) : runtime_error(msg) {}
+};
+
+class TournamentParseError : public TournamentInputError {
+private:
+    size_t line_;
+    size_t column_;
+    string reason_;
+
+public:
+    TournamentParseError(const string& path, size_t line, size_t column, const string& reason)
+        : TournamentInputError("Error: " + path + ":" + to_string(line) + ":" + to_string(column) + ": " + reason),
+        line_(line), column_(column), reason_(reason) {
+    }
+
+    size_t line() const { return line_; }
+    size_t column() const { return column_; }
+    const string& reason() const { return reason_; }
+};
+
+/**
+ * Файл (или его участок), отображённый в память только для чтения
+ *
+ * Владеет отображением и освобождает его в деструкторе. Участок задаётся
+ * смещением и длиной; начало отображения выравнивается вниз до границы,
+ * которую требует система, а data() указывает ровно на запрошенное смещение.
+ */
+class MappedFile {
+private:
+    const char* base_ = nullptr;
+    const char* data_ = nullptr;
+    size_t mappedSize_ = 0;
+    size_t size_ = 0;
+    uint64_t fileSize_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const string& path, uint64_t offset = 0, uint64_t length = UINT64_MAX) {
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            throw TournamentInputError("Error: cannot open file '" + path + "'.");
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file_, &fileSize)) {
+            CloseHandle(file_);
+            throw TournamentInputError("Error: cannot stat file '" + path + "'.");
+        }
+        fileSize_ = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw TournamentInputError("Error: cannot open file '" + path + "'.");
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw TournamentInputError("Error: cannot stat file '" + path + "'.");
+        }
+        fileSize_ = static_cast<uint64_t>(info.st_size);
+#endif
+        offset = min(offset, fileSize_);
+        size_ = static_cast<size_t>(min(length, fileSize_ - offset));
+
+#if defined(_WIN32)
+        SYSTEM_INFO system;
+        GetSystemInfo(&system);
+        uint64_t aligned = offset - offset % system.dwAllocationGranularity;
+        if (size_ > 0) {
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_ == nullptr) {
+                CloseHandle(file_);
+                throw TournamentInputError("Error: cannot map file '" + path + "'.");
+            }
+            mappedSize_ = static_cast<size_t>(offset - aligned) + size_;
+            base_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ,
+                static_cast<DWORD>(aligned >> 32), static_cast<DWORD>(aligned), mappedSize_));
+            if (base_ == nullptr) {
+                CloseHandle(mapping_);
+                CloseHandle(file_);
+                throw TournamentInputError("Error: cannot map file '" + path + "'.");
+            }
+            data_ = base_ + (offset - aligned);
+        }
+#else
+        uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        uint64_t aligned = offset - offset % page;
+        if (size_ > 0) {
+            mappedSize_ = static_cast<size_t>(offset - aligned) + size_;
+            void* mapped = mmap(nullptr, mappedSize_, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(aligned));
+            if (mapped == MAP_FAILED) {
+                close(fd);
+                throw TournamentInputError("Error: cannot map file '" + path + "'.");
+            }
+            madvise(mapped, mappedSize_, MADV_SEQUENTIAL);
+            base_ = static_cast<const char*>(mapped);
+            data_ = base_ + (offset - aligned);
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#if defined(_WIN32)
+        if (base_ != nullptr) UnmapViewOfFile(base_);
+        if (mapping_ != nullptr) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#else
+        if (base_ != nullptr) munmap(const_cast<char*>(base_), mappedSize_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    uint64_t fileSize() const { return fileSize_; }
+};
+
+/**
+ * Потоковый разбор целых чисел из текста в памяти на основе from_chars
+ *
+ * Отслеживает строку и столбец, чтобы сообщать о месте ошибки.
+ */
+class IntegerScanner {
+private:
+    const char* cur_;
+    const char* end_;
+    const char* lineStart_;
+    size_t line_ = 1;
+    string source_;
+
+    void skipWhitespace() {
+        while (cur_ < end_) {
+            char c = *cur_;
+            if (c == '\n') {
+                line_++;
+                lineStart_ = cur_ + 1;
+            }
+            else if (c != ' ' && c != '\t' && c != '\r') {
+                break;
+            }
+            cur_++;
+        }
+    }
+
+    size_t column() const { return static_cast<size_t>(cur_ - lineStart_) + 1; }
+
+public:
+    IntegerScanner(const char* data, size_t size, string source)
+        : cur_(data), end_(data + size), lineStart_(data), source_(move(source)) {
+    }
+
+    /**
+     * Чтение следующего целого числа
+     *
+     * @param what описание ожидаемого значения для сообщения об ошибке
+     * @return возвращает прочитанное число
+     */
+    template <typename T>
+    T next(const char* what) {
+        skipWhitespace();
+        if (cur_ >= end_) {
+            throw TournamentParseError(source_, line_, column(), string("unexpected end of file, expected ") + what);
+        }
+        T value{};
+        from_chars_result result = from_chars(cur_, end_, value);
+        if (result.ec == errc::result_out_of_range) {
+            throw TournamentParseError(source_, line_, column(), string(what) + " is out of range");
+        }
+        if (result.ec != errc() || (result.ptr < end_ && !isspace(static_cast<unsigned char>(*result.ptr)))) {
+            throw TournamentParseError(source_, line_, column(), string("malformed ") + what);
+        }
+        cur_ = result.ptr;
+        return value;
+    }
+
+    /**
+     * Место следующего числа (строка, столбец) для сообщений об ошибках
+     */
+    pair<size_t, size_t> position() {
+        skipWhitespace();
+        return { line_, column() };
+    }
+
+    /**
+     * Количество ещё не прочитанных байтов
+     */
+    size_t remaining() const { return static_cast<size_t>(end_ - cur_); }
+
+    /**
+     * Проверка, остались ли в тексте данные кроме пробельных символов
+     */
+    bool atEnd() {
+        skipWhitespace();
+        return cur_ >= end_;
+    }
+
+    /**
+     * Проверка, что после данных остались только пробельные символы
+     *
+     * @param reason текст ошибки, если данные остались
+     */
+    void expectEnd(const char* reason = "unexpected data after the last knight") {
+        skipWhitespace();
+        if (cur_ < end_) {
+            throw TournamentParseError(source_, line_, column(), reason);
+        }
+    }
+};
+
+/**
+ * Скалярное ядро суммирования с 64-битным накоплением
+ *
+ * @param data указатель на первый элемент
+ * @param size количество элементов
+ * @return возвращает сумму элементов
+ */
+long long sumKernelScalar(const int* data, size_t size) {
+    long long sum = 0;
+    for (size_t j = 0; j < size; j++) {
+        sum += data[j];
+    }
+    return sum;
+}
+
+#ifdef KNIGHTS_X86
+/**
+ * Ядро суммирования SSE2: знаковое расширение до 64-битных линий вручную
+ * (pmovsxdq появляется только в SSE4.1)
+ */
+KNIGHTS_TARGET("sse2")
+long long sumKernelSse2(const int* data, size_t size) {
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    size_t j = 0;
+    for (; j + 4 <= size; j += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j));
+        __m128i sign = _mm_srai_epi32(v, 31);
+        acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v, sign));
+        acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v, sign));
+    }
+    alignas(16) long long lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(acc0, acc1));
+    long long sum = lanes[0] + lanes[1];
+    for (; j < size; j++) {
+        sum += data[j];
+    }
+    return sum;
+}
+
+/**
+ * Ядро суммирования AVX2: 8 элементов за итерацию в четырёх 64-битных линиях
+ */
+KNIGHTS_TARGET("avx2")
+long long sumKernelAvx2(const int* data, size_t size) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t j = 0;
+    for (; j + 8 <= size; j += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j + 4));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(lo));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(hi));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+    long long sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; j < size; j++) {
+        sum += data[j];
+    }
+    return sum;
+}
+
+/**
+ * Ядро суммирования AVX-512: 16 элементов за итерацию в восьми 64-битных линиях
+ */
+KNIGHTS_TARGET("avx512f")
+long long sumKernelAvx512(const int* data, size_t size) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    size_t j = 0;
+    for (; j + 16 <= size; j += 16) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + j));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + j + 8));
+        acc0 = _mm512_add_epi64(acc0, _mm512_maskz_cvtepi32_epi64(0xFF, lo));
+        acc1 = _mm512_add_epi64(acc1, _mm512_maskz_cvtepi32_epi64(0xFF, hi));
+    }
+    alignas(64) long long lanes[8];
+    _mm512_store_si512(lanes, _mm512_add_epi64(acc0, acc1));
+    long long sum = 0;
+    for (long long lane : lanes) {
+        sum += lane;
+    }
+    for (; j < size; j++) {
+        sum += data[j];
+    }
+    return sum;
+}
+
+/**
+ * Проверка поддержки AVX2 процессором и операционной системой
+ */
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+/**
+ * Проверка поддержки AVX-512F процессором и операционной системой
+ */
+bool cpuSupportsAvx512() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0xE6) != 0xE6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 16)) != 0;
+#else
+    return __builtin_cpu_supports("avx512f");
+#endif
+}
+#endif
+
+/**
+ * Ядро суммирования строки матрицы
+ */
+struct SumKernel {
+    const char* name;
+    long long (*sum)(const int* data, size_t size);
+};
+
+/**
+ * Список ядер суммирования, поддерживаемых текущим процессором
+ *
+ * @return возвращает ядра от самого простого к самому широкому
+ */
+vector<SumKernel> availableSumKernels() {
+    vector<SumKernel> kernels = { { "scalar", sumKernelScalar } };
+#ifdef KNIGHTS_X86
+    kernels.push_back({ "sse2", sumKernelSse2 });
+    if (cpuSupportsAvx2()) {
+        kernels.push_back({ "avx2", sumKernelAvx2 });
+    }
+    if (cpuSupportsAvx512()) {
+        kernels.push_back({ "avx512", sumKernelAvx512 });
+    }
+#endif
+    return kernels;
+}
+
+/**
+ * Выбор самого широкого доступного ядра суммирования (выполняется один раз)
+ *
+ * @return возвращает активное ядро суммирования
+ */
+const SumKernel& activeSumKernel() {
+    static const SumKernel kernel = availableSumKernels().back();
+    return kernel;
+}
+
+/**
+ * Ядро суммирования узких сил (int8_t, int16_t)
+ *
+ * Блоки суммируются в 32-битном аккумуляторе (компилятор векторизует
+ * расширение), размер блока выбран так, чтобы сумма блока не превысила 2^30;
+ * суммы блоков складываются в 64-битный итог, поэтому результат точный.
+ *
+ * @param data указатель на первый элемент
+ * @param size количество элементов
+ * @return возвращает сумму элементов
+ */
+template <typename T>
+long long sumKernelNarrow(const T* data, size_t size) {
+    static_assert(sizeof(T) < sizeof(int), "narrow kernel is for 8- and 16-bit strengths");
+    const size_t block = size_t(1) << (31 - 8 * sizeof(T));
+
+    long long sum = 0;
+    for (size_t start = 0; start < size; start += block) {
+        size_t stop = min(size, start + block);
+        int blockSum = 0;
+        for (size_t j = start; j < stop; j++) {
+            blockSum += data[j];
+        }
+        sum += blockSum;
+    }
+    return sum;
+}
+
+/**
+ * Сумма строки произвольной длины для любого типа хранения сил
+ *
+ * @param data указатель на первый элемент
+ * @param size количество элементов
+ * @return возвращает сумму элементов
+ */
+template <typename T>
+long long sumRow(const T* data, size_t size) {
+    if constexpr (is_same<T, int>::value) {
+        return activeSumKernel().sum(data, size);
+    }
+    else {
+        return sumKernelNarrow(data, size);
+    }
+}
+
+/**
+ * Полностью развёрнутая сумма строки фиксированной длины M
+ */
+template <size_t M, typename T, size_t... I>
+long long sumFixedUnrolled(const T* row, index_sequence<I...>) {
+    return (0LL + ... + static_cast<long long>(row[I]));
+}
+
+template <size_t M, typename T>
+long long sumFixed(const T* row) {
+    return sumFixedUnrolled<M>(row, make_index_sequence<M>());
+}
+
+/**
+ * Ядро суммирования фиксированной длины в сигнатуре SumKernel (размер игнорируется)
+ */
+template <size_t M>
+long long sumKernelFixed(const int* data, size_t) {
+    return sumFixed<M>(data);
+}
+
+/**
+ * Специализированное ядро для часто встречающихся длин массива сил (4, 8, 16)
+ *
+ * @param m длина массива сил
+ * @param kernel ссылка для сохранения найденного ядра
+ * @return возвращает true, если для длины m есть специализация
+ */
+bool fixedSumKernel(size_t m, SumKernel& kernel) {
+    switch (m) {
+    case 4: kernel = { "fixed4", sumKernelFixed<4> }; return true;
+    case 8: kernel = { "fixed8", sumKernelFixed<8> }; return true;
+    case 16: kernel = { "fixed16", sumKernelFixed<16> }; return true;
+    default: return false;
+    }
+}
+
+/**
+ * Вычисление суммы элементов массива
+ *
+ * Для длин 4, 8 и 16 используется развёрнутая специализация, для остальных -
+ * векторное ядро, выбранное по возможностям процессора (для int) или блочное
+ * ядро узких типов; накопление 64-битное, результат совпадает со скалярным ядром.
+ *
+ * @param array массив чисел для суммирования
+ * @return возвращает сумму всех элементов массива
+ */
+template <typename T>
+long long calculateSum(const BasicKnightRow<T>& array) {
+    switch (array.size()) {
+    case 4: return sumFixed<4>(array.data());
+    case 8: return sumFixed<8>(array.data());
+    case 16: return sumFixed<16>(array.data());
+    default: return sumRow(array.data(), array.size());
+    }
+}
+
+/**
+ * Результат ранжирования турнира
+ *
+ * Хранит сумму сил каждого рыцаря и индексы победителя и проигравшего,
+ * чтобы последующие запросы и вывод не сканировали матрицу повторно.
+ */
+struct TournamentRanking {
+    vector<long long> sums; // Сумма сил рыцаря i
+    int maxIndex = -1;      // Индекс рыцаря с максимальной суммой сил
+    int minIndex = -1;      // Индекс рыцаря с минимальной суммой сил
+};
+
+/**
+ * Частичный результат поиска на диапазоне рыцарей
+ */
+struct RankingPartial {
+    long long maxSum = LLONG_MIN;
+    long long minSum = LLONG_MAX;
+    int maxIndex = -1;
+    int minIndex = -1;
+};
+
+/**
+ * Ранжирование диапазона рыцарей с массивами сил фиксированной длины M
+ *
+ * Шаг по строкам и сумма строки известны на этапе компиляции, поэтому
+ * редукция развёрнута полностью, а проверок длины в цикле нет.
+ */
+template <size_t M, typename T>
+RankingPartial rankKnightsRangeFixed(const BasicKnightsView<T>& knights, size_t begin, size_t end, long long* sums) {
+    RankingPartial partial;
+    const T* row = knights.data() + begin * M;
+
+    for (size_t i = begin; i < end; i++, row += M) {
+        long long currentSum = sumFixed<M>(row);
+        sums[i] = currentSum;
+        if (currentSum > partial.maxSum) {
+            partial.maxSum = currentSum;
+            partial.maxIndex = static_cast<int>(i);
+        }
+        if (currentSum < partial.minSum) {
+            partial.minSum = currentSum;
+            partial.minIndex = static_cast<int>(i);
+        }
+    }
+
+    return partial;
+}
+
+/**
+ * Ранжирование диапазона рыцарей произвольной длины массива сил
+ */
+template <typename T>
+RankingPartial rankKnightsRangeGeneric(const BasicKnightsView<T>& knights, size_t begin, size_t end, long long* sums) {
+    RankingPartial partial;
+
+    for (size_t i = begin; i < end; i++) {
+        BasicKnightRow<T> row = knights.row(i);
+        long long currentSum = sumRow(row.data(), row.size());
+        sums[i] = currentSum;
+        if (currentSum > partial.maxSum) {
+            partial.maxSum = currentSum;
+            partial.maxIndex = static_cast<int>(i);
+        }
+        if (currentSum < partial.minSum) {
+            partial.minSum = currentSum;
+            partial.minIndex = static_cast<int>(i);
+        }
+    }
+
+    return partial;
+}
+
+/**
+ * Ранжирование диапазона рыцарей [begin, end)
+ *
+ * Специализация выбирается по длине массива сил: 4, 8, 16 или общий случай.
+ *
+ * @param knights матрица сил всех рыцарей
+ * @param begin индекс первого рыцаря диапазона
+ * @param end индекс за последним рыцарем диапазона
+ * @param sums массив для записи сумм (индексируется глобальным номером рыцаря)
+ * @return возвращает локальные максимум и минимум диапазона
+ */
+template <typename T>
+RankingPartial rankKnightsRange(const BasicKnightsView<T>& knights, size_t begin, size_t end, long long* sums) {
+    switch (knights.cols()) {
+    case 4: return rankKnightsRangeFixed<4>(knights, begin, end, sums);
+    case 8: return rankKnightsRangeFixed<8>(knights, begin, end, sums);
+    case 16: return rankKnightsRangeFixed<16>(knights, begin, end, sums);
+    default: return rankKnightsRangeGeneric(knights, begin, end, sums);
+    }
+}
+
+/**
+ * Слияние частичного результата следующего по порядку диапазона
+ *
+ * Сравнения строгие, а диапазоны сливаются по возрастанию индексов,
+ * поэтому при равенстве сумм побеждает меньший индекс, как в последовательном поиске.
+ *
+ * @param total накопленный результат предыдущих диапазонов
+ * @param next результат следующего диапазона
+ */
+void mergeRankingPartial(RankingPartial& total, const RankingPartial& next) {
+    if (next.maxIndex >= 0 && next.maxSum > total.maxSum) {
+        total.maxSum = next.maxSum;
+        total.maxIndex = next.maxIndex;
+    }
+    if (next.minIndex >= 0 && next.minSum < total.minSum) {
+        total.minSum = next.minSum;
+        total.minIndex = next.minIndex;
+    }
+}
+
+/**
+ * Число потоков по умолчанию
+ *
+ * @return возвращает количество аппаратных потоков (не меньше 1)
+ */
+unsigned defaultThreadCount() {
+    unsigned count = thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+/**
+ * Ранжирование турнира за один проход по матрице
+ *
+ * Сумма каждого рыцаря вычисляется ровно один раз; максимум и минимум
+ * ищутся одновременно (строгие сравнения: при равенстве побеждает меньший индекс).
+ * Рыцари делятся на непрерывные блоки по числу потоков; каждый поток хранит
+ * локальные argmax/argmin, которые затем сливаются по порядку блоков.
+ *
+ * @param knights матрица сил всех рыцарей
+ * @param threadCount количество рабочих потоков
+ * @return возвращает суммы всех рыцарей и индексы максимума и минимума
+ */
+template <typename T>
+TournamentRanking rankTournament(const BasicKnightsView<T>& knights, unsigned threadCount = 1) {
+    TournamentRanking ranking;
+    ranking.sums.resize(knights.rows());
+
+    size_t n = knights.rows();
+    size_t workers = max<size_t>(1, min<size_t>(threadCount, n));
+    size_t chunk = (n + workers - 1) / workers;
+
+    vector<RankingPartial> partials(workers);
+    vector<thread> pool;
+    pool.reserve(workers - 1);
+
+    for (size_t w = 1; w < workers; w++) {
+        size_t begin = min(n, w * chunk);
+        size_t end = min(n, begin + chunk);
+        pool.emplace_back([&knights, &ranking, &partials, w, begin, end]() {
+            partials[w] = rankKnightsRange(knights, begin, end, ranking.sums.data());
+        });
+    }
+    partials[0] = rankKnightsRange(knights, 0, min(n, chunk), ranking.sums.data());
+
+    for (thread& worker : pool) {
+        worker.join();
+    }
+
+    RankingPartial total;
+    for (const RankingPartial& partial : partials) {
+        mergeRankingPartial(total, partial);
+    }
+    ranking.maxIndex = total.maxIndex;
+    ranking.minIndex = total.minIndex;
+
+    return ranking;
+}
+
+/**
+ * Поиск рыцаря с максимальной суммой сил
+ *
+ * @param ranking результат ранжирования турнира
+ * @return возвращает индекс рыцаря с максимальной суммой сил
+ */
+int findKnightWithMaxSum(const TournamentRanking& ranking) {
+    return ranking.maxIndex;
+}
+
+/**
+ * Поиск рыцаря с минимальной суммой сил
+ *
+ * @param ranking результат ранжирования турнира
+ * @return возвращает индекс рыцаря с минимальной суммой сил
+ */
+int findKnightWithMinSum(const TournamentRanking& ranking) {
+    return ranking.minIndex;
+}
+
+/**
+ * Порог перехода от ограниченной кучи к выборке nth_element:
+ * при k * KNIGHTS_SELECT_RATIO > n выборка O(n) выгоднее кучи O(n log k)
+ */
+const size_t KNIGHTS_SELECT_RATIO = 16;
+
+/**
+ * Выбор k лучших рыцарей по заданному порядку без полной сортировки всех сумм
+ *
+ * Для малых k используется ограниченная куча, для больших - nth_element;
+ * отсортированы только выбранные k рыцарей.
+ *
+ * @param n количество рыцарей
+ * @param k количество выбираемых рыцарей
+ * @param better строгий порядок: true, если рыцарь a должен стоять выше b
+ *        (параметр шаблона, чтобы сравнения встраивались в кучу и сортировку)
+ * @return возвращает индексы выбранных рыцарей в порядке убывания места
+ */
+template <typename Better>
+vector<int> selectKnights(size_t n, size_t k, const Better& better) {
+    k = min(k, n);
+    vector<int> selected;
+    if (k == 0) {
+        return selected;
+    }
+
+    if (k * KNIGHTS_SELECT_RATIO > n) {
+        selected.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            selected[i] = static_cast<int>(i);
+        }
+        if (k < n) {
+            nth_element(selected.begin(), selected.begin() + (k - 1), selected.end(), better);
+        }
+        selected.resize(k);
+    }
+    else {
+        // Куча с худшим из выбранных на вершине
+        selected.reserve(k);
+        for (size_t i = 0; i < n; i++) {
+            int knight = static_cast<int>(i);
+            if (selected.size() < k) {
+                selected.push_back(knight);
+                push_heap(selected.begin(), selected.end(), better);
+            }
+            else if (better(knight, selected.front())) {
+                pop_heap(selected.begin(), selected.end(), better);
+                selected.back() = knight;
+                push_heap(selected.begin(), selected.end(), better);
+            }
+        }
+    }
+
+    sort(selected.begin(), selected.end(), better);
+    return selected;
+}
+
+/**
+ * k рыцарей с наибольшей суммой сил (при равенстве выше меньший индекс)
+ *
+ * @param ranking результат ранжирования турнира
+ * @param k размер таблицы лидеров
+ * @return возвращает индексы рыцарей от первого места вниз
+ */
+vector<int> topKnights(const TournamentRanking& ranking, size_t k) {
+    const vector<long long>& sums = ranking.sums;
+    return selectKnights(sums.size(), k, [&sums](int a, int b) {
+        return sums[a] != sums[b] ? sums[a] > sums[b] : a < b;
+        });
+}
+
+/**
+ * k рыцарей с наименьшей суммой сил (при равенстве выше меньший индекс)
+ *
+ * @param ranking результат ранжирования турнира
+ * @param k размер таблицы аутсайдеров
+ * @return возвращает индексы рыцарей от самого слабого вверх
+ */
+vector<int> bottomKnights(const TournamentRanking& ranking, size_t k) {
+    const vector<long long>& sums = ranking.sums;
+    return selectKnights(sums.size(), k, [&sums](int a, int b) {
+        return sums[a] != sums[b] ? sums[a] < sums[b] : a < b;
+        });
+}
+
+/**
+ * Процентильный ранг рыцаря: доля рыцарей слабее него плюс половина равных ему
+ *
+ * @param ranking результат ранжирования турнира
+ * @param knight индекс рыцаря
+ * @return возвращает процентиль в диапазоне [0, 100]
+ */
+double percentileRank(const TournamentRanking& ranking, int knight) {
+    long long target = ranking.sums[knight];
+    size_t less = 0;
+    size_t equal = 0;
+    for (long long sum : ranking.sums) {
+        less += sum < target;
+        equal += sum == target;
+    }
+    return 100.0 * (static_cast<double>(less) + 0.5 * static_cast<double>(equal)) / ranking.sums.size();
+}
+
+/**
+ * Процентильные ранги группы рыцарей за один проход по суммам
+ *
+ * Вместо k отдельных проходов O(n) выполняется один проход O(n log k)
+ * с двоичным поиском по отсортированным суммам группы.
+ *
+ * @param ranking результат ранжирования турнира
+ * @param knights индексы рыцарей
+ * @return возвращает процентили в порядке knights
+ */
+vector<double> percentileRanks(const TournamentRanking& ranking, const vector<int>& knights) {
+    vector<long long> targets;
+    targets.reserve(knights.size());
+    for (int knight : knights) {
+        targets.push_back(ranking.sums[knight]);
+    }
+    sort(targets.begin(), targets.end());
+    targets.erase(unique(targets.begin(), targets.end()), targets.end());
+
+    // less[p] - число сумм строго меньше targets[p] (через разностный массив)
+    vector<size_t> less(targets.size() + 1, 0);
+    vector<size_t> equal(targets.size(), 0);
+    for (long long sum : ranking.sums) {
+        size_t above = upper_bound(targets.begin(), targets.end(), sum) - targets.begin();
+        less[above]++;
+        if (above > 0 && targets[above - 1] == sum) {
+            equal[above - 1]++;
+        }
+    }
+    for (size_t p = 1; p < less.size(); p++) {
+        less[p] += less[p - 1];
+    }
+
+    vector<double> ranks;
+    ranks.reserve(knights.size());
+    for (int knight : knights) {
+        size_t p = lower_bound(targets.begin(), targets.end(), ranking.sums[knight]) - targets.begin();
+        ranks.push_back(100.0 * (static_cast<double>(less[p]) + 0.5 * static_cast<double>(equal[p])) / ranking.sums.size());
+    }
+    return ranks;
+}
+
+/**
+ * Показатели рыцаря, по которым можно ранжировать турнир
+ */
+enum class KnightMetric {
+    Sum,
+    Min,
+    Max,
+    Mean,
+    Variance
+};
+
+/**
+ * Таблица профилей рыцарей в виде структуры массивов
+ *
+ * Каждый столбец - отдельный непрерывный массив, поэтому ранжирование
+ * по одному показателю читает только его.
+ */
+struct KnightProfiles {
+    vector<long long> sum;   // Сумма сил
+    vector<int> min;         // Наименьшая сила
+    vector<int> max;         // Наибольшая (пиковая) сила
+    vector<double> mean;     // Средняя сила
+    vector<double> variance; // Дисперсия сил (по генеральной совокупности)
+
+    size_t size() const { return sum.size(); }
+};
+
+/**
+ * Вычисление профилей диапазона рыцарей [begin, end)
+ *
+ * Матрица читается один раз: сумма, минимум и максимум считаются за проход
+ * по строке, отклонения от среднего - повторным проходом по той же строке,
+ * которая к этому моменту уже в кэше L1.
+ */
+template <typename T>
+void profileKnightsRange(const BasicKnightsView<T>& knights, size_t begin, size_t end, KnightProfiles& profiles) {
+    size_t m = knights.cols();
+
+    for (size_t i = begin; i < end; i++) {
+        const T* row = knights.row(i).data();
+
+        long long sum = 0;
+        int low = row[0];
+        int high = row[0];
+        for (size_t j = 0; j < m; j++) {
+            int value = row[j];
+            sum += value;
+            low = value < low ? value : low;
+            high = value > high ? value : high;
+        }
+
+        double mean = static_cast<double>(sum) / m;
+        double squares = 0.0;
+        for (size_t j = 0; j < m; j++) {
+            double deviation = row[j] - mean;
+            squares += deviation * deviation;
+        }
+
+        profiles.sum[i] = sum;
+        profiles.min[i] = low;
+        profiles.max[i] = high;
+        profiles.mean[i] = mean;
+        profiles.variance[i] = squares / m;
+    }
+}
+
+/**
+ * Вычисление таблицы профилей всех рыцарей за один проход по матрице
+ *
+ * @param knights матрица сил всех рыцарей
+ * @param threadCount количество рабочих потоков
+ * @return возвращает таблицу профилей
+ */
+template <typename T>
+KnightProfiles computeKnightProfiles(const BasicKnightsView<T>& knights, unsigned threadCount = 1) {
+    size_t n = knights.rows();
+    KnightProfiles profiles;
+    profiles.sum.resize(n);
+    profiles.min.resize(n);
+    profiles.max.resize(n);
+    profiles.mean.resize(n);
+    profiles.variance.resize(n);
+    if (n == 0 || knights.cols() == 0) {
+        return profiles;
+    }
+
+    size_t workers = max<size_t>(1, min<size_t>(threadCount, n));
+    size_t chunk = (n + workers - 1) / workers;
+    vector<thread> pool;
+    pool.reserve(workers - 1);
+
+    for (size_t w = 1; w < workers; w++) {
+        size_t begin = min(n, w * chunk);
+        size_t end = min(n, begin + chunk);
+        pool.emplace_back([&knights, &profiles, begin, end]() {
+            profileKnightsRange(knights, begin, end, profiles);
+        });
+    }
+    profileKnightsRange(knights, 0, min(n, chunk), profiles);
+
+    for (thread& worker : pool) {
+        worker.join();
+    }
+
+    return profiles;
+}
+
+/**
+ * Разбор названия показателя
+ *
+ * @param name sum, min, max, mean или variance
+ * @return возвращает показатель
+ */
+KnightMetric parseKnightMetric(const string& name) {
+    if (name == "sum") return KnightMetric::Sum;
+    if (name == "min") return KnightMetric::Min;
+    if (name == "max") return KnightMetric::Max;
+    if (name == "mean") return KnightMetric::Mean;
+    if (name == "variance") return KnightMetric::Variance;
+    throw invalid_argument("Error: unknown metric '" + name + "' (expected sum, min, max, mean or variance).");
+}
+
+/**
+ * Название показателя для вывода
+ */
+const char* knightMetricName(KnightMetric metric) {
+    switch (metric) {
+    case KnightMetric::Min: return "MIN";
+    case KnightMetric::Max: return "MAX";
+    case KnightMetric::Mean: return "MEAN";
+    case KnightMetric::Variance: return "VARIANCE";
+    default: return "SUM";
+    }
+}
+
+/**
+ * Выбор k рыцарей по одному столбцу таблицы профилей
+ *
+ * @param column столбец показателя
+ * @param k количество рыцарей
+ * @param highest true - наибольшие значения, false - наименьшие (при равенстве выше меньший индекс)
+ * @return возвращает индексы рыцарей в порядке места
+ */
+template <typename V>
+vector<int> selectKnightsByColumn(const vector<V>& column, size_t k, bool highest) {
+    return selectKnights(column.size(), k, [&column, highest](int a, int b) {
+        if (column[a] != column[b]) {
+            return highest ? column[a] > column[b] : column[a] < column[b];
+        }
+        return a < b;
+        });
+}
+
+/**
+ * Ранжирование по любому показателю без повторного чтения матрицы
+ *
+ * @param profiles таблица профилей
+ * @param metric показатель
+ * @param k количество рыцарей
+ * @param highest true - лидеры по показателю, false - аутсайдеры
+ * @return возвращает индексы рыцарей в порядке места
+ */
+vector<int> rankKnightsByMetric(const KnightProfiles& profiles, KnightMetric metric, size_t k, bool highest) {
+    switch (metric) {
+    case KnightMetric::Min: return selectKnightsByColumn(profiles.min, k, highest);
+    case KnightMetric::Max: return selectKnightsByColumn(profiles.max, k, highest);
+    case KnightMetric::Mean: return selectKnightsByColumn(profiles.mean, k, highest);
+    case KnightMetric::Variance: return selectKnightsByColumn(profiles.variance, k, highest);
+    default: return selectKnightsByColumn(profiles.sum, k, highest);
+    }
+}
+
+// --- Круговой турнир поединков ---
+// В поединке рыцари сравниваются по каждой позиции массива сил; побеждает
+// тот, кто сильнее в большем числе позиций, при равенстве - ничья.
+
+/**
+ * Скалярное ядро поединка
+ *
+ * @param a массив сил первого рыцаря
+ * @param b массив сил второго рыцаря
+ * @param size длина массивов
+ * @return возвращает (позиции, выигранные a) - (позиции, выигранные b)
+ */
+template <typename T>
+int duelKernelScalar(const T* a, const T* b, size_t size) {
+    int score = 0;
+    for (size_t j = 0; j < size; j++) {
+        score += (a[j] > b[j]) - (a[j] < b[j]);
+    }
+    return score;
+}
+
+#ifdef KNIGHTS_X86
+/**
+ * Ядро поединка SSE2: маски сравнений (-1/0) накапливаются в четырёх линиях
+ */
+KNIGHTS_TARGET("sse2")
+int duelKernelSse2(const int* a, const int* b, size_t size) {
+    __m128i acc = _mm_setzero_si128();
+    size_t j = 0;
+    for (; j + 4 <= size; j += 4) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + j));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        acc = _mm_sub_epi32(acc, _mm_cmpgt_epi32(va, vb));
+        acc = _mm_add_epi32(acc, _mm_cmpgt_epi32(vb, va));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    int score = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return score + duelKernelScalar(a + j, b + j, size - j);
+}
+
+/**
+ * Ядро поединка AVX2: 8 позиций за итерацию
+ */
+KNIGHTS_TARGET("avx2")
+int duelKernelAvx2(const int* a, const int* b, size_t size) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t j = 0;
+    for (; j + 8 <= size; j += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(va, vb));
+        acc = _mm256_add_epi32(acc, _mm256_cmpgt_epi32(vb, va));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int score = 0;
+    for (int lane : lanes) {
+        score += lane;
+    }
+    return score + duelKernelScalar(a + j, b + j, size - j);
+}
+
+/**
+ * Ядро поединка SSE2 для 16-битных сил: 8 позиций за итерацию
+ *
+ * Разность масок (+1/-1/0) расширяется в 32-битные линии через madd.
+ */
+KNIGHTS_TARGET("sse2")
+int duelKernelSse2(const int16_t* a, const int16_t* b, size_t size) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+    size_t j = 0;
+    for (; j + 8 <= size; j += 8) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + j));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i diff = _mm_sub_epi16(_mm_cmpgt_epi16(vb, va), _mm_cmpgt_epi16(va, vb));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(diff, ones));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    int score = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return score + duelKernelScalar(a + j, b + j, size - j);
+}
+
+/**
+ * Ядро поединка SSE2 для 8-битных сил: 16 позиций за итерацию
+ *
+ * Разности копятся в 8-битных линиях не дольше 127 итераций, затем
+ * расширяются до 16 бит и через madd сбрасываются в 32-битный аккумулятор.
+ */
+KNIGHTS_TARGET("sse2")
+int duelKernelSse2(const int8_t* a, const int8_t* b, size_t size) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc = _mm_setzero_si128();
+    size_t j = 0;
+    while (j + 16 <= size) {
+        __m128i block = _mm_setzero_si128();
+        for (int step = 0; step < 127 && j + 16 <= size; step++, j += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + j));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+            block = _mm_sub_epi8(block, _mm_cmpgt_epi8(va, vb));
+            block = _mm_add_epi8(block, _mm_cmpgt_epi8(vb, va));
+        }
+        __m128i low = _mm_srai_epi16(_mm_unpacklo_epi8(block, block), 8);
+        __m128i high = _mm_srai_epi16(_mm_unpackhi_epi8(block, block), 8);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(low, ones));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(high, ones));
+    }
+    alignas(16) int lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    int score = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return score + duelKernelScalar(a + j, b + j, size - j);
+}
+
+/**
+ * Ядро поединка AVX2 для 16-битных сил: 16 позиций за итерацию
+ */
+KNIGHTS_TARGET("avx2")
+int duelKernelAvx2(const int16_t* a, const int16_t* b, size_t size) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    size_t j = 0;
+    for (; j + 16 <= size; j += 16) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+        __m256i diff = _mm256_sub_epi16(_mm256_cmpgt_epi16(vb, va), _mm256_cmpgt_epi16(va, vb));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(diff, ones));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int score = 0;
+    for (int lane : lanes) {
+        score += lane;
+    }
+    return score + duelKernelScalar(a + j, b + j, size - j);
+}
+
+/**
+ * Ядро поединка AVX2 для 8-битных сил: 32 позиции за итерацию
+ *
+ * Как и в SSE2-варианте, 8-битные линии сбрасываются каждые 127 итераций.
+ */
+KNIGHTS_TARGET("avx2")
+int duelKernelAvx2(const int8_t* a, const int8_t* b, size_t size) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    size_t j = 0;
+    while (j + 32 <= size) {
+        __m256i block = _mm256_setzero_si256();
+        for (int step = 0; step < 127 && j + 32 <= size; step++, j += 32) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + j));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+            block = _mm256_sub_epi8(block, _mm256_cmpgt_epi8(va, vb));
+            block = _mm256_add_epi8(block, _mm256_cmpgt_epi8(vb, va));
+        }
+        __m256i low = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(block));
+        __m256i high = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(block, 1));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(low, ones));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(high, ones));
+    }
+    alignas(32) int lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int score = 0;
+    for (int lane : lanes) {
+        score += lane;
+    }
+    return score + duelKernelScalar(a + j, b + j, size - j);
+}
+#endif
+
+/**
+ * Ядро поединка для типа хранения сил T
+ */
+template <typename T>
+using DuelKernel = int (*)(const T* a, const T* b, size_t size);
+
+/**
+ * Выбор самого широкого доступного ядра поединка для int, int16_t и int8_t (выполняется один раз)
+ */
+template <typename T>
+DuelKernel<T> activeDuelKernel() {
+#ifdef KNIGHTS_X86
+    static const DuelKernel<T> kernel = cpuSupportsAvx2()
+        ? static_cast<DuelKernel<T>>(duelKernelAvx2)
+        : static_cast<DuelKernel<T>>(duelKernelSse2);
+#else
+    static const DuelKernel<T> kernel = duelKernelScalar<T>;
+#endif
+    return kernel;
+}
+
+/**
+ * Счёт поединка для любого типа хранения сил
+ */
+template <typename T>
+int duelScore(const T* a, const T* b, size_t size) {
+    if constexpr (is_same<T, int>::value || is_same<T, int16_t>::value || is_same<T, int8_t>::value) {
+        return activeDuelKernel<T>()(a, b, size);
+    }
+    else {
+        return duelKernelScalar(a, b, size);
+    }
+}
+
+/**
+ * Итоги кругового турнира поединков
+ */
+struct DuelTable {
+    vector<int> wins;   // Выигранные поединки рыцаря i
+    vector<int> draws;  // Ничьи рыцаря i
+    vector<int> losses; // Проигранные поединки рыцаря i
+
+    /**
+     * Очки рыцаря: 2 за победу, 1 за ничью
+     */
+    long long points(size_t i) const { return 2LL * wins[i] + draws[i]; }
+};
+
+/**
+ * Размер блока рыцарей для тайлинга: два блока строк должны помещаться в L2
+ */
+const size_t DUEL_TILE_BYTES = 128 * 1024;
+
+/**
+ * Круговой турнир: каждый рыцарь сражается с каждым
+ *
+ * Пары обрабатываются блоками (тайлами) строк, чтобы оба блока оставались
+ * в кэше; пары блоков раздаются потокам через атомарный счётчик, у каждого
+ * потока свои счётчики побед, которые складываются в конце.
+ *
+ * @param knights матрица сил всех рыцарей
+ * @param threadCount количество рабочих потоков
+ * @return возвращает таблицу побед, ничьих и поражений
+ */
+template <typename T>
+DuelTable runRoundRobin(const BasicKnightsView<T>& knights, unsigned threadCount = 1) {
+    size_t n = knights.rows();
+    size_t m = knights.cols();
+    size_t tile = max<size_t>(1, DUEL_TILE_BYTES / 2 / max<size_t>(1, m * sizeof(T)));
+    size_t tiles = (n + tile - 1) / tile;
+
+    // Пары блоков (I <= J) в одном линейном списке
+    vector<pair<size_t, size_t>> tilePairs;
+    tilePairs.reserve(tiles * (tiles + 1) / 2);
+    for (size_t ti = 0; ti < tiles; ti++) {
+        for (size_t tj = ti; tj < tiles; tj++) {
+            tilePairs.push_back({ ti, tj });
+        }
+    }
+
+    size_t workers = max<size_t>(1, min<size_t>(threadCount, tilePairs.size()));
+    vector<DuelTable> locals(workers);
+    atomic<size_t> nextPair(0);
+
+    auto work = [&](size_t w) {
+        DuelTable& local = locals[w];
+        local.wins.assign(n, 0);
+        local.draws.assign(n, 0);
+        local.losses.assign(n, 0);
+
+        for (size_t p = nextPair++; p < tilePairs.size(); p = nextPair++) {
+            size_t beginA = tilePairs[p].first * tile;
+            size_t endA = min(n, beginA + tile);
+            size_t beginB = tilePairs[p].second * tile;
+            size_t endB = min(n, beginB + tile);
+
+            for (size_t a = beginA; a < endA; a++) {
+                const T* rowA = knights.row(a).data();
+                for (size_t b = max(beginB, a + 1); b < endB; b++) {
+                    int score = duelScore(rowA, knights.row(b).data(), m);
+                    if (score > 0) {
+                        local.wins[a]++;
+                        local.losses[b]++;
+                    }
+                    else if (score < 0) {
+                        local.wins[b]++;
+                        local.losses[a]++;
+                    }
+                    else {
+                        local.draws[a]++;
+                        local.draws[b]++;
+                    }
+                }
+            }
+        }
+    };
+
+    vector<thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t w = 1; w < workers; w++) {
+        pool.emplace_back(work, w);
+    }
+    work(0);
+    for (thread& worker : pool) {
+        worker.join();
+    }
+
+    DuelTable table = move(locals[0]);
+    for (size_t w = 1; w < workers; w++) {
+        for (size_t i = 0; i < n; i++) {
+            table.wins[i] += locals[w].wins[i];
+            table.draws[i] += locals[w].draws[i];
+            table.losses[i] += locals[w].losses[i];
+        }
+    }
+    return table;
+}
+
+/**
+ * Итоговая таблица кругового турнира
+ *
+ * @param table итоги поединков
+ * @return возвращает индексы рыцарей по убыванию очков (при равенстве выше меньший индекс)
+ */
+vector<int> duelStandings(const DuelTable& table) {
+    vector<int> order(table.wins.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<int>(i);
+    }
+    sort(order.begin(), order.end(), [&table](int a, int b) {
+        long long pa = table.points(a);
+        long long pb = table.points(b);
+        return pa != pb ? pa > pb : a < b;
+        });
+    return order;
+}
+
+/**
+ * Потоковый турнир: рыцари поступают по одному, матрица целиком не хранится
+ *
+ * Хранит только текущие максимум и минимум и массивы сил двух лидеров,
+ * поэтому память ограничена O(m) независимо от числа рыцарей.
+ */
+class StreamingTournament {
+private:
+    size_t cols_;
+    size_t count_ = 0;
+    long long maxSum_ = LLONG_MIN;
+    long long minSum_ = LLONG_MAX;
+    int maxIndex_ = -1;
+    int minIndex_ = -1;
+    vector<int> maxRow_;
+    vector<int> minRow_;
+
+public:
+    explicit StreamingTournament(size_t m) : cols_(m), maxRow_(m), minRow_(m) {}
+
+    /**
+     * Учёт очередного рыцаря (строгие сравнения: при равенстве остаётся более ранний)
+     *
+     * @param row массив сил рыцаря длины m
+     */
+    template <typename T>
+    void addKnight(const BasicKnightRow<T>& row) {
+        long long currentSum = calculateSum(row);
+        if (currentSum > maxSum_) {
+            maxSum_ = currentSum;
+            maxIndex_ = static_cast<int>(count_);
+            copy(row.begin(), row.end(), maxRow_.begin());
+        }
+        if (currentSum < minSum_) {
+            minSum_ = currentSum;
+            minIndex_ = static_cast<int>(count_);
+            copy(row.begin(), row.end(), minRow_.begin());
+        }
+        count_++;
+    }
+
+    size_t cols() const { return cols_; }
+    size_t count() const { return count_; }
+    int maxIndex() const { return maxIndex_; }
+    int minIndex() const { return minIndex_; }
+    long long maxSum() const { return maxSum_; }
+    long long minSum() const { return minSum_; }
+    KnightRow maxRow() const { return KnightRow(maxRow_.data(), cols_); }
+    KnightRow minRow() const { return KnightRow(minRow_.data(), cols_); }
+};
+
+/**
+ * Турнир с изменяемыми силами рыцарей
+ *
+ * Поддерживает суммы рыцарей инкрементально и хранит дерево отрезков
+ * с argmax/argmin над суммами: изменение одной силы стоит O(log n),
+ * запрос лидера и аутсайдера - O(1).
+ */
+class LiveTournament {
+private:
+    KnightsMatrix knights_;
+    TournamentRanking ranking_;
+    size_t leaves_ = 1;
+    vector<int> maxTree_; // Индекс рыцаря с максимальной суммой в узле (-1 - пустой узел)
+    vector<int> minTree_; // Индекс рыцаря с минимальной суммой в узле (-1 - пустой узел)
+
+    int betterMax(int a, int b) const {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        const vector<long long>& sums = ranking_.sums;
+        if (sums[a] != sums[b]) return sums[a] > sums[b] ? a : b;
+        return min(a, b);
+    }
+
+    int betterMin(int a, int b) const {
+        if (a < 0) return b;
+        if (b < 0) return a;
+        const vector<long long>& sums = ranking_.sums;
+        if (sums[a] != sums[b]) return sums[a] < sums[b] ? a : b;
+        return min(a, b);
+    }
+
+    void pull(size_t node) {
+        maxTree_[node] = betterMax(maxTree_[2 * node], maxTree_[2 * node + 1]);
+        minTree_[node] = betterMin(minTree_[2 * node], minTree_[2 * node + 1]);
+    }
+
+public:
+    /**
+     * Построение по исходной матрице (данные копируются в 32-битную матрицу,
+     * чтобы их можно было менять на любые значения int)
+     *
+     * @param knights матрица сил всех рыцарей
+     * @param threadCount количество потоков для начального ранжирования
+     */
+    template <typename T>
+    LiveTournament(const BasicKnightsView<T>& knights, unsigned threadCount = 1)
+        : knights_(knights.rows(), knights.cols()) {
+        copy(knights.data(), knights.data() + knights.rows() * knights.cols(), knights_.data());
+        ranking_ = rankTournament(knights_.view(), threadCount);
+
+        size_t n = knights_.rows();
+        while (leaves_ < n) {
+            leaves_ *= 2;
+        }
+        maxTree_.assign(2 * leaves_, -1);
+        minTree_.assign(2 * leaves_, -1);
+        for (size_t i = 0; i < n; i++) {
+            maxTree_[leaves_ + i] = static_cast<int>(i);
+            minTree_[leaves_ + i] = static_cast<int>(i);
+        }
+        for (size_t node = leaves_ - 1; node >= 1; node--) {
+            pull(node);
+        }
+    }
+
+    /**
+     * Изменение одной силы рыцаря
+     *
+     * @param knight индекс рыцаря
+     * @param slot индекс силы в массиве рыцаря
+     * @param value новое значение силы
+     */
+    void update(size_t knight, size_t slot, int value) {
+        if (knight >= knights_.rows() || slot >= knights_.cols()) {
+            throw out_of_range("Error: knight " + to_string(knight + 1) + ", slot " + to_string(slot + 1) + " is out of range.");
+        }
+
+        int& cell = knights_.at(knight, slot);
+        ranking_.sums[knight] += static_cast<long long>(value) - cell;
+        cell = value;
+
+        for (size_t node = (leaves_ + knight) / 2; node >= 1; node /= 2) {
+            pull(node);
+        }
+        ranking_.maxIndex = maxTree_[1];
+        ranking_.minIndex = minTree_[1];
+    }
+
+    int maxIndex() const { return maxTree_[1]; }
+    int minIndex() const { return minTree_[1]; }
+    long long sum(size_t knight) const { return ranking_.sums[knight]; }
+
+    KnightsView view() const { return knights_.view(); }
+    const TournamentRanking& ranking() const { return ranking_; }
+};
+
+/**
+ * Ввод данных о силах рыцарей
+ *
+ * @param knights ссылка на матрицу для заполнения данными
+ */
+void inputKnightsData(KnightsMatrix& knights) {
+    for (size_t i = 0; i < knights.rows(); i++) {
+        cout << "Enter strengths of knight " << i + 1 << " (" << knights.cols() << " numbers): ";
+        for (size_t j = 0; j < knights.cols(); j++) {
+            cin >> knights.at(i, j);
+        }
+    }
+}
+
+/**
+ * Чтение заголовка текстового турнира "n m"
+ *
+ * Каждой силе нужны хотя бы цифра и разделитель, поэтому заголовок,
+ * обещающий больше сил, чем помещается в оставшемся тексте, отклоняется
+ * до выделения памяти с указанием места заголовка.
+ *
+ * @param scanner сканер, стоящий перед заголовком
+ * @param source имя источника для сообщений об ошибках
+ * @param n ссылка для сохранения количества рыцарей
+ * @param m ссылка для сохранения длины массива сил
+ */
+void readKnightsTextHeader(IntegerScanner& scanner, const string& source, int& n, int& m) {
+    pair<size_t, size_t> at = scanner.position();
+    n = scanner.next<int>("number of knights");
+    m = scanner.next<int>("strength array length");
+    if (n <= 0 || m <= 0) {
+        throw TournamentInputError("Error: " + source + ": knights count and array length must be positive.");
+    }
+    uint64_t values = static_cast<uint64_t>(n) * static_cast<uint64_t>(m);
+    if (values > (static_cast<uint64_t>(scanner.remaining()) + 1) / 2) {
+        throw TournamentParseError(source, at.first, at.second,
+            "header declares " + to_string(n) + " x " + to_string(m) + " strengths, more than the file can hold");
+    }
+}
+
+/**
+ * Разбор текстового турнира из памяти без диалога
+ *
+ * Формат: n m, затем n*m целых чисел (силы рыцарей построчно),
+ * разделённых пробелами или переводами строк.
+ *
+ * @param data указатель на текст
+ * @param size длина текста в байтах
+ * @param source имя источника для сообщений об ошибках
+ * @return возвращает заполненную матрицу сил
+ */
+KnightsMatrix parseKnightsText(const char* data, size_t size, const string& source) {
+    IntegerScanner scanner(data, size, source);
+
+    int n = 0;
+    int m = 0;
+    readKnightsTextHeader(scanner, source, n, m);
+
+    KnightsMatrix knights(n, m);
+    int* out = knights.data();
+    size_t total = knights.rows() * knights.cols();
+    for (size_t k = 0; k < total; k++) {
+        out[k] = scanner.next<int>("knight strength");
+    }
+    scanner.expectEnd();
+
+    return knights;
+}
+
+// --- Бинарный формат турнира ---
+// Заголовок фиксированного размера (32 байта, порядок байтов платформы),
+// за ним матрица сил построчно без разделителей. Размер заголовка кратен
+// 32, поэтому данные в отображении выровнены для векторных загрузок.
+const char KNIGHTS_BINARY_MAGIC[4] = { 'K', 'N', 'T', 'B' };
+
+enum class StrengthType : uint32_t {
+    Int8 = 1,
+    Int16 = 2,
+    Int32 = 4
+};
+
+/**
+ * Соответствие типа хранения силы и кода типа в бинарном формате
+ */
+template <typename T>
+struct StrengthTraits;
+
+template <>
+struct StrengthTraits<int8_t> {
+    static constexpr StrengthType type = StrengthType::Int8;
+};
+
+template <>
+struct StrengthTraits<int16_t> {
+    static constexpr StrengthType type = StrengthType::Int16;
+};
+
+template <>
+struct StrengthTraits<int> {
+    static constexpr StrengthType type = StrengthType::Int32;
+};
+
+/**
+ * Название типа хранения силы для вывода
+ */
+const char* strengthTypeName(StrengthType type) {
+    switch (type) {
+    case StrengthType::Int8: return "int8";
+    case StrengthType::Int16: return "int16";
+    default: return "int32";
+    }
+}
+
+/**
+ * Выбор самого узкого типа хранения, в который помещаются все силы
+ *
+ * @param data указатель на силы
+ * @param count количество сил
+ * @return возвращает int8, int16 или int32
+ */
+StrengthType narrowestStrengthType(const int* data, size_t count) {
+    if (count == 0) {
+        return StrengthType::Int8;
+    }
+    auto range = minmax_element(data, data + count);
+    int low = *range.first;
+    int high = *range.second;
+    if (low >= INT8_MIN && high <= INT8_MAX) {
+        return StrengthType::Int8;
+    }
+    if (low >= INT16_MIN && high <= INT16_MAX) {
+        return StrengthType::Int16;
+    }
+    return StrengthType::Int32;
+}
+
+/**
+ * Копирование матрицы сил в более узкий тип хранения
+ *
+ * @param knights исходная матрица (все значения должны помещаться в T)
+ * @return возвращает матрицу с элементами типа T
+ */
+template <typename T>
+BasicKnightsMatrix<T> narrowKnights(const KnightsView& knights) {
+    BasicKnightsMatrix<T> narrow(knights.rows(), knights.cols());
+    const int* source = knights.data();
+    T* target = narrow.data();
+    size_t total = knights.rows() * knights.cols();
+    for (size_t k = 0; k < total; k++) {
+        target[k] = static_cast<T>(source[k]);
+    }
+    return narrow;
+}
+
+struct KnightsFileHeader {
+    char magic[4];
+    uint32_t elementType;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(KnightsFileHeader) == 32, "binary header layout must be 32 bytes");
+
+/**
+ * Запись турнира в бинарный файл (тип элементов берётся из T)
+ *
+ * @param knights матрица сил всех рыцарей
+ * @param path путь к выходному файлу
+ */
+template <typename T>
+void saveKnightsBinary(const BasicKnightsView<T>& knights, const string& path) {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) {
+        throw TournamentInputError("Error: cannot create file '" + path + "'.");
+    }
+
+    KnightsFileHeader header = {};
+    memcpy(header.magic, KNIGHTS_BINARY_MAGIC, sizeof(header.magic));
+    header.elementType = static_cast<uint32_t>(StrengthTraits<T>::type);
+    header.rows = knights.rows();
+    header.cols = knights.cols();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(knights.data()),
+        static_cast<streamsize>(knights.rows() * knights.cols() * sizeof(T)));
+    if (!out) {
+        throw TournamentInputError("Error: failed to write file '" + path + "'.");
+    }
+}
+
+/**
+ * Проверка, что файл в памяти начинается с заголовка бинарного турнира
+ */
+bool isKnightsBinary(const char* data, size_t size) {
+    return size >= sizeof(KnightsFileHeader) && memcmp(data, KNIGHTS_BINARY_MAGIC, sizeof(KNIGHTS_BINARY_MAGIC)) == 0;
+}
+
+/**
+ * Чтение и проверка заголовка бинарного турнира
  *
- * @param array массив чисел для суммирования
- * @return возвращает сумму всех элементов массива
+ * @param data начало отображения
+ * @param size размер отображения
+ * @param source имя источника для сообщений об ошибках
+ * @return возвращает проверенный заголовок; данные начинаются сразу за ним
  */
-int calculateSum(const vector<int>& array) {
-    int sum = 0;
-    for (int num : array) {
-        sum += num;
+KnightsFileHeader readKnightsHeader(const char* data, size_t size, const string& source) {
+    KnightsFileHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    uint32_t width = header.elementType;
+    if (width != static_cast<uint32_t>(StrengthType::Int8) && width != static_cast<uint32_t>(StrengthType::Int16)
+        && width != static_cast<uint32_t>(StrengthType::Int32)) {
+        throw TournamentInputError("Error: " + source + ": unsupported element type " + to_string(width) + ".");
     }
-    return sum;
+    if (header.rows == 0 || header.cols == 0) {
+        throw TournamentInputError("Error: " + source + ": knights count and array length must be positive.");
+    }
+    uint64_t payload = size - sizeof(header);
+    if (header.cols > payload / width || header.rows > payload / width / header.cols
+        || header.rows * header.cols * width != payload) {
+        throw TournamentInputError("Error: " + source + ": file size does not match the header.");
+    }
+
+    return header;
 }
 
 /**
- * Поиск рыцаря с максимальной суммой сил
+ * Загруженный турнир: владеет либо отображением бинарного файла, либо разобранной матрицей
  *
- * @param knights вектор массивов сил всех рыцарей
- * @return возвращает индекс рыцаря с максимальной суммой сил
+ * Силы хранятся в самом узком подходящем типе; view<T>() даёт представление
+ * для type == StrengthTraits<T>::type.
+ */
+struct LoadedTournament {
+    unique_ptr<MappedFile> mapping;           // Отображение бинарного файла (если данные читаются напрямую из него)
+    KnightsMatrix matrix{ 0, 0 };              // Матрица, разобранная из текста или введённая вручную
+    BasicKnightsMatrix<int16_t> matrix16{ 0, 0 };
+    BasicKnightsMatrix<int8_t> matrix8{ 0, 0 };
+    StrengthType type = StrengthType::Int32;
+    const void* data = nullptr;
+    size_t rows = 0;
+    size_t cols = 0;
+
+    template <typename T>
+    BasicKnightsView<T> view() const {
+        return BasicKnightsView<T>(static_cast<const T*>(data), rows, cols);
+    }
+};
+
+/**
+ * Перевод введённой матрицы в самый узкий тип хранения
+ *
+ * Сокращает объём данных, читаемых при поиске, в 2-4 раза; исходная
+ * 32-битная матрица освобождается, если найден более узкий тип.
+ *
+ * @param tournament турнир с заполненной матрицей matrix
+ */
+void compactTournament(LoadedTournament& tournament) {
+    KnightsView wide = tournament.matrix.view();
+    tournament.rows = wide.rows();
+    tournament.cols = wide.cols();
+    tournament.type = narrowestStrengthType(wide.data(), wide.rows() * wide.cols());
+
+    switch (tournament.type) {
+    case StrengthType::Int8:
+        tournament.matrix8 = narrowKnights<int8_t>(wide);
+        tournament.data = tournament.matrix8.data();
+        tournament.matrix = KnightsMatrix(0, 0);
+        break;
+    case StrengthType::Int16:
+        tournament.matrix16 = narrowKnights<int16_t>(wide);
+        tournament.data = tournament.matrix16.data();
+        tournament.matrix = KnightsMatrix(0, 0);
+        break;
+    default:
+        tournament.data = tournament.matrix.data();
+        break;
+    }
+}
+
+/**
+ * Загрузка турнира из файла с автоопределением формата
+ *
+ * Бинарный файл используется напрямую из отображения в записанном типе,
+ * текстовый разбирается в матрицу и переводится в самый узкий тип.
+ *
+ * @param path путь к файлу
+ * @return возвращает загруженный турнир
+ */
+LoadedTournament loadTournament(const string& path) {
+    LoadedTournament tournament;
+    unique_ptr<MappedFile> file(new MappedFile(path));
+
+    if (isKnightsBinary(file->data(), file->size())) {
+        KnightsFileHeader header = readKnightsHeader(file->data(), file->size(), path);
+        tournament.type = static_cast<StrengthType>(header.elementType);
+        tournament.data = file->data() + sizeof(header);
+        tournament.rows = static_cast<size_t>(header.rows);
+        tournament.cols = static_cast<size_t>(header.cols);
+        tournament.mapping = move(file);
+    }
+    else {
+        tournament.matrix = parseKnightsText(file->data(), file->size(), path);
+        compactTournament(tournament);
+    }
+
+    return tournament;
+}
+
+/**
+ * Применение файла изменений к живому турниру
+ *
+ * Формат: тройки "рыцарь слот значение" (номера с 1, как в выводе результатов).
+ *
+ * @param tournament живой турнир
+ * @param path путь к файлу изменений
+ * @return возвращает количество применённых изменений
  */
-int findKnightWithMaxSum(const vector<vector<int>>& knights) {
-    int maxSum = INT_MIN;
-    int knightIndex = -1;
+size_t applyTournamentUpdates(LiveTournament& tournament, const string& path) {
+    MappedFile file(path);
+    IntegerScanner scanner(file.data(), file.size(), path);
 
-    for (int i = 0; i < knights.size(); i++) {
-        int currentSum = calculateSum(knights[i]);
-        if (currentSum > maxSum) {
-            maxSum = currentSum;
-            knightIndex = i;
+    size_t applied = 0;
+    while (!scanner.atEnd()) {
+        long long knight = scanner.next<long long>("knight number");
+        long long slot = scanner.next<long long>("slot number");
+        int value = scanner.next<int>("strength value");
+        if (knight < 1 || slot < 1) {
+            throw TournamentInputError("Error: " + path + ": knight and slot numbers start at 1.");
+        }
+        try {
+            tournament.update(static_cast<size_t>(knight - 1), static_cast<size_t>(slot - 1), value);
         }
+        catch (const out_of_range& e) {
+            throw TournamentInputError(e.what());
+        }
+        applied++;
     }
 
-    return knightIndex;
+    return applied;
 }
 
 /**
- * Поиск рыцаря с минимальной суммой сил
+ * Потоковый разбор текстового турнира: в памяти только одна строка
  *
- * @param knights вектор массивов сил всех рыцарей
- * @return возвращает индекс рыцаря с минимальной суммой сил
+ * @param data указатель на текст
+ * @param size длина текста в байтах
+ * @param source имя источника для сообщений об ошибках
+ * @return возвращает итог потокового турнира
  */
-int findKnightWithMinSum(const vector<vector<int>>& knights) {
-    int minSum = INT_MAX;
-    int knightIndex = -1;
+StreamingTournament streamKnightsText(const char* data, size_t size, const string& source) {
+    IntegerScanner scanner(data, size, source);
+
+    int n = 0;
+    int m = 0;
+    readKnightsTextHeader(scanner, source, n, m);
 
-    for (int i = 0; i < knights.size(); i++) {
-        int currentSum = calculateSum(knights[i]);
-        if (currentSum < minSum) {
-            minSum = currentSum;
-            knightIndex = i;
+    StreamingTournament tournament(m);
+    vector<int> row(m);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < m; j++) {
+            row[j] = scanner.next<int>("knight strength");
         }
+        tournament.addKnight(KnightRow(row.data(), row.size()));
     }
+    scanner.expectEnd();
 
-    return knightIndex;
+    return tournament;
 }
 
 /**
- * Ввод данных о силах рыцарей
+ * Потоковый турнир по строкам готовой матрицы (например, отображённого файла)
+ *
+ * @param knights матрица сил всех рыцарей
+ * @return возвращает итог потокового турнира
+ */
+template <typename T>
+StreamingTournament streamKnightsView(const BasicKnightsView<T>& knights) {
+    StreamingTournament tournament(knights.cols());
+    for (size_t i = 0; i < knights.rows(); i++) {
+        tournament.addKnight(knights.row(i));
+    }
+    return tournament;
+}
+
+/**
+ * Потоковый турнир по файлу (текстовому или бинарному)
+ *
+ * @param path путь к файлу
+ * @return возвращает итог потокового турнира
+ */
+StreamingTournament streamTournament(const string& path) {
+    MappedFile file(path);
+
+    if (!isKnightsBinary(file.data(), file.size())) {
+        return streamKnightsText(file.data(), file.size(), path);
+    }
+
+    KnightsFileHeader header = readKnightsHeader(file.data(), file.size(), path);
+    const char* payload = file.data() + sizeof(header);
+    size_t n = static_cast<size_t>(header.rows);
+    size_t m = static_cast<size_t>(header.cols);
+
+    switch (static_cast<StrengthType>(header.elementType)) {
+    case StrengthType::Int8:
+        return streamKnightsView(BasicKnightsView<int8_t>(reinterpret_cast<const int8_t*>(payload), n, m));
+    case StrengthType::Int16:
+        return streamKnightsView(BasicKnightsView<int16_t>(reinterpret_cast<const int16_t*>(payload), n, m));
+    default:
+        return streamKnightsView(KnightsView(reinterpret_cast<const int*>(payload), n, m));
+    }
+}
+
+/**
+ * Потоковый турнир с интерактивным вводом: каждый рыцарь вводится в один буфер строки
  *
- * @param knights ссылка на вектор для заполнения данными
  * @param n количество рыцарей
  * @param m длина массива сил каждого рыцаря
+ * @return возвращает итог потокового турнира
  */
-void inputKnightsData(vector<vector<int>>& knights, int n, int m) {
+StreamingTournament streamKnightsInput(int n, int m) {
+    StreamingTournament tournament(m);
+    vector<int> row(m);
     for (int i = 0; i < n; i++) {
         cout << "Enter strengths of knight " << i + 1 << " (" << m << " numbers): ";
         for (int j = 0; j < m; j++) {
-            cin >> knights[i][j];
+            cin >> row[j];
+        }
+        tournament.addKnight(KnightRow(row.data(), row.size()));
+    }
+    return tournament;
+}
+
+// --- Многопроцессный турнир по шардам файла ---
+// Файл делится на байтовые диапазоны; каждый рабочий процесс отображает
+// только свой диапазон, ищет локальные максимум и минимум и передаёт итог
+// родителю через канал. Родитель сливает итоги по порядку шардов, переводя
+// локальные индексы в глобальные, поэтому результат совпадает с одним процессом.
+
+/**
+ * Итог шарда, передаваемый через канал (фиксированная часть; за ней
+ * следуют массивы сил лидера и аутсайдера шарда, если rows > 0)
+ */
+struct ShardReport {
+    int32_t failed;       // 1 - шард не удалось обработать
+    uint32_t reserved;
+    uint64_t rows;        // Число рыцарей в шарде
+    uint64_t lines;       // Число строк текста, начинающихся в шарде
+    int64_t maxSum;
+    int64_t minSum;
+    int64_t maxIndex;     // Локальный индекс рыцаря в шарде
+    int64_t minIndex;
+    uint64_t errorLine;   // Локальный номер строки ошибки (с 1), 0 - ошибка не привязана к строке
+    uint64_t errorColumn;
+    char error[256];
+};
+
+/**
+ * Итог шарда вместе с массивами сил его лидера и аутсайдера
+ */
+struct ShardOutcome {
+    ShardReport report = {};
+    vector<int> maxRow;
+    vector<int> minRow;
+};
+
+/**
+ * Итог шарда по результату потокового прохода
+ */
+ShardOutcome shardOutcome(const StreamingTournament& tournament, uint64_t lines) {
+    ShardOutcome outcome;
+    outcome.report.rows = tournament.count();
+    outcome.report.lines = lines;
+    outcome.report.maxSum = tournament.maxSum();
+    outcome.report.minSum = tournament.minSum();
+    outcome.report.maxIndex = tournament.maxIndex();
+    outcome.report.minIndex = tournament.minIndex();
+    outcome.maxRow.assign(tournament.maxRow().begin(), tournament.maxRow().end());
+    outcome.minRow.assign(tournament.minRow().begin(), tournament.minRow().end());
+    return outcome;
+}
+
+/**
+ * Итог шарда, завершившегося ошибкой
+ */
+ShardOutcome failedShard(const string& message, uint64_t line, uint64_t column) {
+    ShardOutcome outcome;
+    outcome.report.failed = 1;
+    outcome.report.errorLine = line;
+    outcome.report.errorColumn = column;
+    snprintf(outcome.report.error, sizeof(outcome.report.error), "%s", message.c_str());
+    return outcome;
+}
+
+/**
+ * Обработка текстового шарда: строки, начинающиеся в байтах [begin, end)
+ *
+ * В шардированном режиме каждый рыцарь записан на отдельной строке.
+ * Отображается только диапазон шарда и небольшой запас под последнюю строку;
+ * если строка выходит за запас, участок отображается заново с её начала.
+ *
+ * @param path путь к файлу
+ * @param begin начало диапазона (не меньше конца строки заголовка)
+ * @param end конец диапазона
+ * @param m длина массива сил
+ * @return возвращает итог шарда
+ */
+ShardOutcome scanTextShard(const string& path, uint64_t begin, uint64_t end, size_t m) {
+    // Отображение начинается на байт раньше, чтобы понять, начинается ли строка ровно в begin
+    uint64_t offset = begin - 1;
+    uint64_t overhang = static_cast<uint64_t>(m) * 12 + 64;
+    unique_ptr<MappedFile> file(new MappedFile(path, offset, end - offset + overhang));
+    const char* mapEnd = file->data() + file->size();
+    const char* shardEnd = file->data() + (end - offset);
+    const char* cur = file->data() + 1;
+    if (file->data()[0] != '\n') {
+        // Строка, начатая до begin, принадлежит предыдущему шарду; если её конец
+        // за пределами отображения, следующая строка начинается уже после end
+        const char* newline = static_cast<const char*>(memchr(cur, '\n', mapEnd - cur));
+        cur = newline != nullptr ? newline + 1 : mapEnd;
+    }
+
+    StreamingTournament tournament(m);
+    vector<int> row(m);
+    uint64_t lines = 0;
+    while (cur < shardEnd && cur < mapEnd) {
+        const char* newline = static_cast<const char*>(memchr(cur, '\n', mapEnd - cur));
+        uint64_t mappedUntil = offset + static_cast<uint64_t>(mapEnd - file->data());
+        if (newline == nullptr && mappedUntil < file->fileSize()) {
+            // Строка длиннее запаса: отображение с начала строки и удвоенным запасом
+            offset += static_cast<uint64_t>(cur - file->data());
+            overhang *= 2;
+            file.reset(new MappedFile(path, offset, end - offset + overhang));
+            mapEnd = file->data() + file->size();
+            shardEnd = file->data() + (end - offset);
+            cur = file->data();
+            continue;
+        }
+        const char* lineEnd = newline != nullptr ? newline : mapEnd;
+        lines++;
+
+        IntegerScanner scanner(cur, lineEnd - cur, path);
+        try {
+            if (!scanner.atEnd()) {
+                for (size_t j = 0; j < m; j++) {
+                    row[j] = scanner.next<int>("knight strength");
+                }
+                scanner.expectEnd("too many strengths on the knight line");
+                tournament.addKnight(KnightRow(row.data(), row.size()));
+            }
+        }
+        catch (const TournamentParseError& e) {
+            return failedShard(e.reason(), lines, e.column());
+        }
+        cur = lineEnd + 1;
+    }
+
+    return shardOutcome(tournament, lines);
+}
+
+/**
+ * Обработка бинарного шарда: рыцари [rowBegin, rowEnd)
+ *
+ * @param path путь к файлу
+ * @param header заголовок файла
+ * @param rowBegin первый рыцарь шарда
+ * @param rowEnd рыцарь за последним в шарде
+ * @return возвращает итог шарда
+ */
+template <typename T>
+ShardOutcome scanBinaryShard(const string& path, const KnightsFileHeader& header, uint64_t rowBegin, uint64_t rowEnd) {
+    uint64_t rowBytes = header.cols * sizeof(T);
+    MappedFile file(path, sizeof(header) + rowBegin * rowBytes, (rowEnd - rowBegin) * rowBytes);
+    BasicKnightsView<T> knights(reinterpret_cast<const T*>(file.data()),
+        static_cast<size_t>(rowEnd - rowBegin), static_cast<size_t>(header.cols));
+    return shardOutcome(streamKnightsView(knights), 0);
+}
+
+/**
+ * Итог шардированного турнира (глобальные индексы)
+ */
+struct ShardedTournament {
+    int maxIndex = -1;
+    int minIndex = -1;
+    long long maxSum = LLONG_MIN;
+    long long minSum = LLONG_MAX;
+    vector<int> maxRow;
+    vector<int> minRow;
+};
+
+/**
+ * Запись всего буфера в дескриптор (с повтором при частичной записи)
+ */
+bool writeAll(int fd, const void* data, size_t size) {
+#if defined(_WIN32)
+    (void)fd; (void)data; (void)size;
+    return false;
+#else
+    const char* cur = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, cur, size);
+        if (written <= 0) return false;
+        cur += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+#endif
+}
+
+/**
+ * Чтение ровно size байт из дескриптора
+ */
+bool readAll(int fd, void* data, size_t size) {
+#if defined(_WIN32)
+    (void)fd; (void)data; (void)size;
+    return false;
+#else
+    char* cur = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t got = read(fd, cur, size);
+        if (got <= 0) return false;
+        cur += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+#endif
+}
+
+/**
+ * Турнир по большому файлу, разделённому на шарды между процессами
+ *
+ * Текстовый файл: первая строка "n m", затем по рыцарю на строку; шарды -
+ * байтовые диапазоны, строка принадлежит шарду, в котором она начинается.
+ * Бинарный файл: шарды - диапазоны целых строк матрицы.
+ * В Windows (нет fork) шарды обрабатываются последовательно в одном процессе.
+ *
+ * @param path путь к файлу
+ * @param shardCount количество шардов (рабочих процессов)
+ * @return возвращает итог с глобальными индексами
+ */
+ShardedTournament runShardedTournament(const string& path, unsigned shardCount) {
+    // Заголовок: формат, n, m и начало данных
+    bool binary;
+    KnightsFileHeader header = {};
+    uint64_t dataBegin;
+    uint64_t dataEnd;
+    uint64_t n;
+    size_t m;
+    {
+        MappedFile file(path);
+        binary = isKnightsBinary(file.data(), file.size());
+        if (binary) {
+            header = readKnightsHeader(file.data(), file.size(), path);
+            n = header.rows;
+            m = static_cast<size_t>(header.cols);
+            dataBegin = 0;
+            dataEnd = header.rows;
+        }
+        else {
+            const char* newline = static_cast<const char*>(memchr(file.data(), '\n', file.size()));
+            size_t headerLength = newline != nullptr ? static_cast<size_t>(newline - file.data()) : file.size();
+            IntegerScanner scanner(file.data(), headerLength, path);
+            int knights = scanner.next<int>("number of knights");
+            int length = scanner.next<int>("strength array length");
+            scanner.expectEnd("the first line must contain only the knights count and array length");
+            if (knights <= 0 || length <= 0) {
+                throw TournamentInputError("Error: " + path + ": knights count and array length must be positive.");
+            }
+            n = static_cast<uint64_t>(knights);
+            m = static_cast<size_t>(length);
+            dataBegin = min<uint64_t>(file.size(), headerLength + 1);
+            dataEnd = file.size();
+        }
+    }
+
+    // Границы шардов: байты текста или строки бинарной матрицы
+    shardCount = static_cast<unsigned>(max<uint64_t>(1, min<uint64_t>(shardCount, dataEnd - dataBegin)));
+    vector<uint64_t> bounds(shardCount + 1);
+    for (unsigned k = 0; k <= shardCount; k++) {
+        bounds[k] = dataBegin + (dataEnd - dataBegin) * k / shardCount;
+    }
+
+    auto scanShard = [&](unsigned k) -> ShardOutcome {
+        try {
+            if (!binary) {
+                return scanTextShard(path, bounds[k], bounds[k + 1], m);
+            }
+            switch (static_cast<StrengthType>(header.elementType)) {
+            case StrengthType::Int8: return scanBinaryShard<int8_t>(path, header, bounds[k], bounds[k + 1]);
+            case StrengthType::Int16: return scanBinaryShard<int16_t>(path, header, bounds[k], bounds[k + 1]);
+            default: return scanBinaryShard<int>(path, header, bounds[k], bounds[k + 1]);
+            }
+        }
+        catch (const exception& e) {
+            return failedShard(e.what(), 0, 0);
+        }
+    };
+
+    vector<ShardOutcome> outcomes(shardCount);
+#if defined(_WIN32)
+    for (unsigned k = 0; k < shardCount; k++) {
+        outcomes[k] = scanShard(k);
+    }
+#else
+    vector<pid_t> children;
+    vector<int> pipes;
+    // При ошибке запуска уже запущенные процессы не должны остаться без ожидания:
+    // закрытые каналы прерывают их запись, после чего они завершаются
+    auto abandonWorkers = [&]() {
+        for (int fd : pipes) {
+            close(fd);
         }
+        for (pid_t child : children) {
+            waitpid(child, nullptr, 0);
+        }
+    };
+    for (unsigned k = 0; k < shardCount; k++) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            abandonWorkers();
+            throw TournamentInputError("Error: cannot create a pipe for shard " + to_string(k + 1) + ".");
+        }
+        cout.flush();
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            abandonWorkers();
+            throw TournamentInputError("Error: cannot start a worker process for shard " + to_string(k + 1) + ".");
+        }
+        if (pid == 0) {
+            // Рабочий процесс: обработать свой шард и отправить итог родителю
+            close(fds[0]);
+            for (int fd : pipes) {
+                close(fd);
+            }
+            ShardOutcome outcome = scanShard(k);
+            bool sent = writeAll(fds[1], &outcome.report, sizeof(outcome.report));
+            if (sent && outcome.report.rows > 0) {
+                sent = writeAll(fds[1], outcome.maxRow.data(), m * sizeof(int))
+                    && writeAll(fds[1], outcome.minRow.data(), m * sizeof(int));
+            }
+            close(fds[1]);
+            _exit(sent ? 0 : 1);
+        }
+        close(fds[1]);
+        children.push_back(pid);
+        pipes.push_back(fds[0]);
+    }
+
+    for (unsigned k = 0; k < shardCount; k++) {
+        ShardOutcome& outcome = outcomes[k];
+        bool received = readAll(pipes[k], &outcome.report, sizeof(outcome.report));
+        if (received && !outcome.report.failed && outcome.report.rows > 0) {
+            outcome.maxRow.resize(m);
+            outcome.minRow.resize(m);
+            received = readAll(pipes[k], outcome.maxRow.data(), m * sizeof(int))
+                && readAll(pipes[k], outcome.minRow.data(), m * sizeof(int));
+        }
+        if (!received) {
+            outcome = failedShard("Error: worker process for shard " + to_string(k + 1) + " did not report.", 0, 0);
+        }
+        close(pipes[k]);
+    }
+    for (pid_t child : children) {
+        waitpid(child, nullptr, 0);
+    }
+#endif
+
+    // Слияние по порядку шардов: строгие сравнения, индексы со смещением
+    ShardedTournament result;
+    uint64_t offset = 0;
+    uint64_t line = 1;
+    for (unsigned k = 0; k < shardCount; k++) {
+        const ShardReport& report = outcomes[k].report;
+        if (report.failed) {
+            if (report.errorLine > 0) {
+                throw TournamentParseError(path, static_cast<size_t>(line + report.errorLine),
+                    static_cast<size_t>(report.errorColumn), report.error);
+            }
+            throw TournamentInputError(report.error);
+        }
+        if (report.rows > 0 && report.maxSum > result.maxSum) {
+            result.maxSum = report.maxSum;
+            result.maxIndex = static_cast<int>(offset + report.maxIndex);
+            result.maxRow = outcomes[k].maxRow;
+        }
+        if (report.rows > 0 && report.minSum < result.minSum) {
+            result.minSum = report.minSum;
+            result.minIndex = static_cast<int>(offset + report.minIndex);
+            result.minRow = outcomes[k].minRow;
+        }
+        offset += report.rows;
+        line += report.lines;
+    }
+
+    if (offset != n) {
+        throw TournamentInputError("Error: " + path + ": expected " + to_string(n) + " knights, found " + to_string(offset) + ".");
+    }
+    return result;
+}
+
+/**
+ * Вывод одного лидера турнира
+ *
+ * @param title заголовок (максимум или минимум)
+ * @param index индекс рыцаря
+ * @param sum сумма сил рыцаря
+ * @param row массив сил рыцаря
+ */
+template <typename T>
+void printKnight(const string& title, int index, long long sum, const BasicKnightRow<T>& row) {
+    cout << title << index + 1 << endl;
+    cout << "Strength sum: " << sum << endl;
+    cout << "Strength array: ";
+    for (T num : row) {
+        cout << static_cast<int>(num) << " ";
     }
 }
 
 /**
  * Вывод результатов поиска рыцарей
  *
- * @param knights вектор массивов сил всех рыцарей
- * @param maxIndex индекс рыцаря с максимальной суммой сил
- * @param minIndex индекс рыцаря с минимальной суммой сил
+ * @param knights матрица сил всех рыцарей
+ * @param ranking результат ранжирования турнира (суммы берутся из него)
+ */
+template <typename T>
+void printResults(const BasicKnightsView<T>& knights, const TournamentRanking& ranking) {
+    int maxIndex = findKnightWithMaxSum(ranking);
+    int minIndex = findKnightWithMinSum(ranking);
+
+    cout << "\n=== TOURNAMENT RESULTS ===" << endl;
+    printKnight("Knight with maximum strength sum: #", maxIndex, ranking.sums[maxIndex], knights.row(maxIndex));
+    cout << "\n" << endl;
+    printKnight("Knight with minimum strength sum: #", minIndex, ranking.sums[minIndex], knights.row(minIndex));
+}
+
+/**
+ * Вывод результатов потокового турнира
+ *
+ * @param tournament итог потокового турнира (хранит массивы сил обоих лидеров)
  */
-void printResults(const vector<vector<int>>& knights, int maxIndex, int minIndex) {
+void printResults(const StreamingTournament& tournament) {
     cout << "\n=== TOURNAMENT RESULTS ===" << endl;
-    cout << "Knight with maximum strength sum: #" << maxIndex + 1 << endl;
-    cout << "Strength sum: " << calculateSum(knights[maxIndex]) << endl;
-    cout << "Strength array: ";
-    for (int num : knights[maxIndex]) {
-        cout << num << " ";
+    printKnight("Knight with maximum strength sum: #", tournament.maxIndex(), tournament.maxSum(), tournament.maxRow());
+    cout << "\n" << endl;
+    printKnight("Knight with minimum strength sum: #", tournament.minIndex(), tournament.minSum(), tournament.minRow());
+}
+
+/**
+ * Вывод результатов шардированного турнира
+ *
+ * @param tournament итог слияния шардов (хранит массивы сил обоих лидеров)
+ */
+void printResults(const ShardedTournament& tournament) {
+    cout << "\n=== TOURNAMENT RESULTS ===" << endl;
+    printKnight("Knight with maximum strength sum: #", tournament.maxIndex, tournament.maxSum,
+        KnightRow(tournament.maxRow.data(), tournament.maxRow.size()));
+    cout << "\n" << endl;
+    printKnight("Knight with minimum strength sum: #", tournament.minIndex, tournament.minSum,
+        KnightRow(tournament.minRow.data(), tournament.minRow.size()));
+}
+
+/**
+ * Вывод таблицы лидеров и аутсайдеров с процентильными рангами
+ *
+ * @param ranking результат ранжирования турнира
+ * @param k размер таблиц
+ */
+void printLeaderboard(const TournamentRanking& ranking, size_t k) {
+    vector<int> top = topKnights(ranking, k);
+    vector<double> topRanks = percentileRanks(ranking, top);
+    cout << "\n\n=== TOP " << k << " KNIGHTS ===" << endl;
+    for (size_t place = 0; place < top.size(); place++) {
+        cout << place + 1 << ". Knight #" << top[place] + 1 << " - sum " << ranking.sums[top[place]]
+            << " (percentile " << topRanks[place] << ")" << endl;
     }
 
-    cout << "\n\nKnight with minimum strength sum: #" << minIndex + 1 << endl;
-    cout << "Strength sum: " << calculateSum(knights[minIndex]) << endl;
-    cout << "Strength array: ";
-    for (int num : knights[minIndex]) {
-        cout << num << " ";
+    vector<int> bottom = bottomKnights(ranking, k);
+    vector<double> bottomRanks = percentileRanks(ranking, bottom);
+    cout << "\n=== BOTTOM " << k << " KNIGHTS ===" << endl;
+    for (size_t place = 0; place < bottom.size(); place++) {
+        cout << place + 1 << ". Knight #" << bottom[place] + 1 << " - sum " << ranking.sums[bottom[place]]
+            << " (percentile " << bottomRanks[place] << ")" << endl;
     }
 }
 
-int main() {
-    int n;
-    int m;
+/**
+ * Вывод рыцарей с наибольшим и наименьшим значением показателя и их профилей
+ *
+ * @param profiles таблица профилей
+ * @param metric показатель ранжирования
+ * @param k размер таблиц
+ */
+void printProfileLeaderboard(const KnightProfiles& profiles, KnightMetric metric, size_t k) {
+    auto printProfile = [&profiles](size_t place, int knight) {
+        cout << place << ". Knight #" << knight + 1 << " - sum " << profiles.sum[knight]
+            << ", min " << profiles.min[knight] << ", max " << profiles.max[knight]
+            << ", mean " << profiles.mean[knight] << ", variance " << profiles.variance[knight] << endl;
+    };
 
-    cout << "=== KINGDOM KNIGHTS TOURNAMENT ===" << endl;
-    cout << "Enter number of knights: ";
-    cin >> n;
-    cout << "Enter length of strength array for each knight: ";
-    cin >> m;
+    vector<int> highest = rankKnightsByMetric(profiles, metric, k, true);
+    cout << "\n\n=== HIGHEST " << knightMetricName(metric) << " ===" << endl;
+    for (size_t place = 0; place < highest.size(); place++) {
+        printProfile(place + 1, highest[place]);
+    }
+
+    vector<int> lowest = rankKnightsByMetric(profiles, metric, k, false);
+    cout << "\n=== LOWEST " << knightMetricName(metric) << " ===" << endl;
+    for (size_t place = 0; place < lowest.size(); place++) {
+        printProfile(place + 1, lowest[place]);
+    }
+}
+
+/**
+ * Вывод итоговой таблицы кругового турнира
+ *
+ * @param table итоги поединков
+ * @param limit сколько первых мест вывести
+ */
+void printDuelStandings(const DuelTable& table, size_t limit) {
+    vector<int> standings = duelStandings(table);
+    limit = min(limit, standings.size());
+
+    cout << "\n\n=== ROUND-ROBIN STANDINGS ===" << endl;
+    for (size_t place = 0; place < limit; place++) {
+        int knight = standings[place];
+        cout << place + 1 << ". Knight #" << knight + 1 << " - " << table.points(knight) << " points ("
+            << table.wins[knight] << " wins, " << table.draws[knight] << " draws, "
+            << table.losses[knight] << " losses)" << endl;
+    }
+}
+
+/**
+ * Параметры запуска турнира
+ */
+struct TournamentOptions {
+    unsigned threads = defaultThreadCount(); // Количество рабочих потоков поиска
+    string inputPath;                        // Файл с данными (пусто - интерактивный ввод)
+    string saveBinaryPath;                   // Куда сохранить турнир в бинарном формате
+    bool stream = false;                     // Потоковый режим: память O(m)
+    size_t leaderboardSize = 0;              // Размер таблицы лидеров (0 - не выводить)
+    string updatesPath;                      // Файл изменений сил для живого турнира
+    bool profile = false;                    // Построить профили рыцарей и ранжировать по показателю
+    KnightMetric metric = KnightMetric::Sum; // Показатель ранжирования профилей
+    bool duels = false;                      // Провести круговой турнир поединков
+    unsigned shards = 0;                     // Число процессов-шардов (0 - без шардирования)
+};
+
+/**
+ * Разбор аргументов командной строки
+ *
+ * Поддерживается: --threads N, --input PATH (текстовый или бинарный файл),
+ * --save-binary PATH, --stream, --top K, --updates PATH,
+ * --rank-by sum|min|max|mean|variance, --duels, --shards K
+ *
+ * @param argc количество аргументов
+ * @param argv массив аргументов
+ * @return возвращает параметры запуска
+ */
+TournamentOptions parseOptions(int argc, char* argv[]) {
+    TournamentOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads") {
+            if (i + 1 >= argc) {
+                throw invalid_argument("Error: --threads requires a value.");
+            }
+            int value = atoi(argv[++i]);
+            if (value <= 0) {
+                throw invalid_argument("Error: --threads must be a positive number.");
+            }
+            options.threads = static_cast<unsigned>(value);
+        }
+        else if (arg == "--input") {
+            if (i + 1 >= argc) {
+                throw invalid_argument("Error: --input requires a file path.");
+            }
+            options.inputPath = argv[++i];
+        }
+        else if (arg == "--save-binary") {
+            if (i + 1 >= argc) {
+                throw invalid_argument("Error: --save-binary requires a file path.");
+            }
+            options.saveBinaryPath = argv[++i];
+        }
+        else if (arg == "--stream") {
+            options.stream = true;
+        }
+        else if (arg == "--top") {
+            if (i + 1 >= argc) {
+                throw invalid_argument("Error: --top requires a value.");
+            }
+            int value = atoi(argv[++i]);
+            if (value <= 0) {
+                throw invalid_argument("Error: --top must be a positive number.");
+            }
+            options.leaderboardSize = static_cast<size_t>(value);
+        }
+        else if (arg == "--updates") {
+            if (i + 1 >= argc) {
+                throw invalid_argument("Error: --updates requires a file path.");
+            }
+            options.updatesPath = argv[++i];
+        }
+        else if (arg == "--rank-by") {
+            if (i + 1 >= argc) {
+                throw invalid_argument("Error: --rank-by requires a metric.");
+            }
+            options.profile = true;
+            options.metric = parseKnightMetric(argv[++i]);
+        }
+        else if (arg == "--duels") {
+            options.duels = true;
+        }
+        else if (arg == "--shards") {
+            if (i + 1 >= argc) {
+                throw invalid_argument("Error: --shards requires a value.");
+            }
+            int value = atoi(argv[++i]);
+            if (value <= 0) {
+                throw invalid_argument("Error: --shards must be a positive number.");
+            }
+            options.shards = static_cast<unsigned>(value);
+        }
+        else {
+            throw invalid_argument("Error: unknown argument '" + arg + "'.");
+        }
+    }
+
+    if (options.stream && options.leaderboardSize > 0) {
+        throw invalid_argument("Error: --top needs all knight sums and cannot be used with --stream.");
+    }
+    if (options.stream && options.profile) {
+        throw invalid_argument("Error: --rank-by needs the whole matrix and cannot be used with --stream.");
+    }
+    if (options.stream && options.duels) {
+        throw invalid_argument("Error: --duels needs the whole matrix and cannot be used with --stream.");
+    }
+    if (options.shards > 0 && (options.inputPath.empty() || options.stream || options.leaderboardSize > 0
+        || options.profile || options.duels || !options.updatesPath.empty() || !options.saveBinaryPath.empty())) {
+        throw invalid_argument("Error: --shards needs --input and only finds the strongest and weakest knights.");
+    }
+    if (options.stream && !options.updatesPath.empty()) {
+        throw invalid_argument("Error: --updates needs the whole matrix and cannot be used with --stream.");
+    }
 
-    vector<vector<int>> knights(n, vector<int>(m));
+    return options;
+}
 
-    // Ввод
-    inputKnightsData(knights, n, m);
+/**
+ * Поиск, вывод и обработка изменений для загруженного турнира
+ *
+ * @param knights матрица сил всех рыцарей в выбранном типе хранения
+ * @param options параметры запуска
+ * @return возвращает код завершения программы
+ */
+template <typename T>
+int runTournament(const BasicKnightsView<T>& knights, const TournamentOptions& options) {
+    if (!options.saveBinaryPath.empty()) {
+        try {
+            saveKnightsBinary(knights, options.saveBinaryPath);
+        }
+        catch (const TournamentInputError& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
 
-    // Поиск
-    int maxKnightIndex = findKnightWithMaxSum(knights);
-    int minKnightIndex = findKnightWithMinSum(knights);
+    // Поиск (один проход по матрице, рыцари распределены между потоками)
+    TournamentRanking ranking = rankTournament(knights, options.threads);
 
     // Вывод
-    printResults(knights, maxKnightIndex, minKnightIndex);
+    printResults(knights, ranking);
+    if (options.leaderboardSize > 0) {
+        printLeaderboard(ranking, options.leaderboardSize);
+    }
+
+    if (options.profile) {
+        // Профили: все показатели за один проход, ранжирование по столбцу
+        KnightProfiles profiles = computeKnightProfiles(knights, options.threads);
+        printProfileLeaderboard(profiles, options.metric, max<size_t>(1, options.leaderboardSize));
+    }
+
+    if (options.duels) {
+        // Круговой турнир: O(n^2 * m) сравнений, блоками по всем потокам
+        DuelTable table = runRoundRobin(knights, options.threads);
+        printDuelStandings(table, options.leaderboardSize > 0 ? options.leaderboardSize : knights.rows());
+    }
+
+    if (!options.updatesPath.empty()) {
+        // Живой турнир: изменения сил применяются инкрементально
+        LiveTournament live(knights, options.threads);
+        try {
+            size_t applied = applyTournamentUpdates(live, options.updatesPath);
+            cout << "\n\nApplied " << applied << " strength updates." << endl;
+        }
+        catch (const TournamentInputError& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        printResults(live.view(), live.ranking());
+        if (options.leaderboardSize > 0) {
+            printLeaderboard(live.ranking(), options.leaderboardSize);
+        }
+    }
 
     return 0;
-}
\ No newline at end of file
+}
+
+// Бенчмарк (U.LAB.1.bench.cpp) подключает этот файл без собственной точки входа
+#ifndef KNIGHTS_NO_MAIN
+int main(int argc, char* argv[]) {
+    TournamentOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const invalid_argument& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    cout << "=== KINGDOM KNIGHTS TOURNAMENT ===" << endl;
+
+    if (options.shards > 0) {
+        // Шардированный режим: файл делится между рабочими процессами
+        try {
+            printResults(runShardedTournament(options.inputPath, options.shards));
+        }
+        catch (const TournamentInputError& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (options.stream) {
+        // Потоковый режим: рыцари читаются по одному, матрица не хранится
+        try {
+            if (!options.inputPath.empty()) {
+                printResults(streamTournament(options.inputPath));
+            }
+            else {
+                int n;
+                int m;
+
+                cout << "Enter number of knights: ";
+                cin >> n;
+                cout << "Enter length of strength array for each knight: ";
+                cin >> m;
+
+                printResults(streamKnightsInput(n, m));
+            }
+        }
+        catch (const TournamentInputError& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    LoadedTournament tournament;
+    if (!options.inputPath.empty()) {
+        // Пакетный ввод из файла
+        try {
+            tournament = loadTournament(options.inputPath);
+        }
+        catch (const TournamentInputError& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+    else {
+        int n;
+        int m;
+
+        cout << "Enter number of knights: ";
+        cin >> n;
+        cout << "Enter length of strength array for each knight: ";
+        cin >> m;
+
+        tournament.matrix = KnightsMatrix(n, m);
+
+        // Ввод
+        inputKnightsData(tournament.matrix);
+        compactTournament(tournament);
+    }
+
+    // Поиск и вывод в типе хранения, выбранном при загрузке
+    switch (tournament.type) {
+    case StrengthType::Int8:
+        return runTournament(tournament.view<int8_t>(), options);
+    case StrengthType::Int16:
+        return runTournament(tournament.view<int16_t>(), options);
+    default:
+        return runTournament(tournament.view<int>(), options);
+    }
+}
+#endif
\ No newline at end of file
@@ -3,130 +3,2095 @@
 #include <ctime>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+#include <limits>
+#include <cstring>
+#include <array>
+#include <iterator>
+#include <utility>
+#include <deque>
+#include <memory>
+#include <fstream>
+#include <cstdio>
+#include <queue>
+#include <chrono>
+#include <charconv>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define INCOME_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+// Атрибут целевого набора инструкций для отдельных функций (GCC/Clang);
+// MSVC разрешает интринсики без него
+#if defined(__GNUC__) || defined(__clang__)
+#define INCOME_TARGET(isa) __attribute__((target(isa)))
+#else
+#define INCOME_TARGET(isa)
+#endif
+
+/**
+ * Число потоков по умолчанию
+ *
+ * @return возвращает количество аппаратных потоков (не меньше 1).
+ */
+unsigned defaultThreadCount() {
+    unsigned count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+/**
+ * Запуск функции на нескольких потоках: fn(w) для w = 0..workers-1
+ * (нулевой номер выполняется в текущем потоке)
+ */
+template <typename Fn>
+void runWorkers(size_t workers, const Fn& fn) {
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < workers; w++) {
+        pool.emplace_back([&fn, w]() { fn(w); });
+    }
+    fn(0);
+    for (std::thread& worker : pool) {
+        worker.join();
+    }
+}
+
+/**
+ * Счётчиковый генератор Philox4x32-10
+ *
+ * Результат зависит только от ключа (seed) и номера счётчика, поэтому
+ * любой участок последовательности вычисляется независимо - без общего
+ * состояния и с одинаковым результатом при любом числе потоков.
+ *
+ * @param counter номер блока из четырёх 32-битных слов.
+ * @param seed ключ генератора.
+ * @param out массив для записи четырёх слов.
+ */
+inline void philox4x32(uint64_t counter, uint64_t seed, uint32_t out[4]) {
+    const uint32_t M0 = 0xD2511F53u;
+    const uint32_t M1 = 0xCD9E8D57u;
+    const uint32_t W0 = 0x9E3779B9u;
+    const uint32_t W1 = 0xBB67AE85u;
+
+    uint32_t c0 = static_cast<uint32_t>(counter);
+    uint32_t c1 = static_cast<uint32_t>(counter >> 32);
+    uint32_t c2 = 0;
+    uint32_t c3 = 0;
+    uint32_t k0 = static_cast<uint32_t>(seed);
+    uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+
+    for (int round = 0; round < 10; round++) {
+        uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+        uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+        uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n1 = static_cast<uint32_t>(p1);
+        uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        uint32_t n3 = static_cast<uint32_t>(p0);
+        c0 = n0;
+        c1 = n1;
+        c2 = n2;
+        c3 = n3;
+        k0 += W0;
+        k1 += W1;
+    }
+
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+/**
+ * Заполнение участка [begin, end) массива случайными числами
+ *
+ * Элемент i берёт 64 бита из счётчика i / 2 (половина i % 2) и переводится
+ * в [0, 1) по старшим 53 битам. Сначала блок заполняется долями [0, 1),
+ * затем отдельный векторизуемый цикл переводит их в [min, max].
+ *
+ * @param arr указатель на массив.
+ * @param begin первый элемент участка.
+ * @param end элемент за последним.
+ * @param min минимальное значение.
+ * @param max максимальное значение.
+ * @param seed ключ генератора.
+ */
+void fillRange(double* arr, size_t begin, size_t end, double min, double max, uint64_t seed) {
+    const size_t BLOCK = 512;
+    const double scale = max - min;
+    double unit[BLOCK];
+
+    for (size_t start = begin; start < end; start += BLOCK) {
+        size_t count = std::min(BLOCK, end - start);
+
+        for (size_t k = 0; k < count; ) {
+            size_t i = start + k;
+            uint32_t words[4];
+            philox4x32(i / 2, seed, words);
+            for (size_t half = i % 2; half < 2 && k < count; half++, k++) {
+                uint64_t bits = (static_cast<uint64_t>(words[2 * half]) << 32) | words[2 * half + 1];
+                unit[k] = static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+            }
+        }
+
+        double* out = arr + start;
+        for (size_t k = 0; k < count; k++) {
+            out[k] = min + unit[k] * scale;
+        }
+    }
+}
+
+/**
+ * Заполнение массива случайными числами в заданном диапазоне
+ *
+ * Массив делится между потоками; для одного seed результат одинаков
+ * при любом числе потоков.
+ *
+ * @param arr указатель на массив.
+ * @param N размер массива.
+ * @param min минимальное значение.
+ * @param max максимальное значение.
+ * @param seed ключ генератора.
+ * @param threads количество потоков.
+ */
+void fillArray(double* arr, size_t N, double min, double max, uint64_t seed, unsigned threads = 1) {
+    size_t workers = std::max<size_t>(1, std::min<size_t>(threads, N));
+    size_t chunk = (N + workers - 1) / workers;
+    runWorkers(workers, [&](size_t w) {
+        size_t begin = std::min(N, w * chunk);
+        size_t end = std::min(N, begin + chunk);
+        fillRange(arr, begin, end, min, max, seed);
+    });
+}
+
+/**
+ * Результат поиска экстремумов на участке массива
+ */
+struct ExtremesResult {
+    size_t maxIndex = 0;
+    size_t minIndex = 0;
+};
+
+/**
+ * Слияние результата следующего по порядку участка
+ *
+ * Сравнения строгие, поэтому при равенстве остаётся более ранний месяц.
+ */
+void mergeExtremes(const double* arr, ExtremesResult& total, const ExtremesResult& next) {
+    if (arr[next.maxIndex] > arr[total.maxIndex]) {
+        total.maxIndex = next.maxIndex;
+    }
+    if (arr[next.minIndex] < arr[total.minIndex]) {
+        total.minIndex = next.minIndex;
+    }
+}
+
+/**
+ * Скалярный поиск экстремумов на участке [begin, end), begin < end
+ */
+ExtremesResult extremesScalar(const double* arr, size_t begin, size_t end) {
+    ExtremesResult result;
+    result.maxIndex = result.minIndex = begin;
+
+    for (size_t i = begin + 1; i < end; i++) {
+        if (arr[i] > arr[result.maxIndex]) {
+            result.maxIndex = i;
+        }
+        if (arr[i] < arr[result.minIndex]) {
+            result.minIndex = i;
+        }
+    }
+    return result;
+}
+
+/**
+ * Сведение линий векторного поиска: среди линий с лучшим значением
+ * выбирается наименьший индекс (первое вхождение)
+ */
+ExtremesResult reduceExtremeLanes(const double* arr, const double* maxIdx, const double* minIdx, int lanes) {
+    ExtremesResult result;
+    result.maxIndex = static_cast<size_t>(maxIdx[0]);
+    result.minIndex = static_cast<size_t>(minIdx[0]);
+    for (int lane = 1; lane < lanes; lane++) {
+        size_t mx = static_cast<size_t>(maxIdx[lane]);
+        size_t mn = static_cast<size_t>(minIdx[lane]);
+        if (arr[mx] > arr[result.maxIndex] || (arr[mx] == arr[result.maxIndex] && mx < result.maxIndex)) {
+            result.maxIndex = mx;
+        }
+        if (arr[mn] < arr[result.minIndex] || (arr[mn] == arr[result.minIndex] && mn < result.minIndex)) {
+            result.minIndex = mn;
+        }
+    }
+    return result;
+}
+
+#ifdef INCOME_X86
+/**
+ * Поиск экстремумов AVX2: в каждой из 4 линий хранится лучшее значение и его
+ * индекс (индексы до 2^53 точно представимы в double); ветвлений в цикле нет
+ */
+INCOME_TARGET("avx2")
+ExtremesResult extremesAvx2(const double* arr, size_t begin, size_t end) {
+    if (end - begin < 8) {
+        return extremesScalar(arr, begin, end);
+    }
+
+    __m256d maxVal = _mm256_loadu_pd(arr + begin);
+    __m256d minVal = maxVal;
+    __m256d index = _mm256_setr_pd(static_cast<double>(begin), static_cast<double>(begin + 1),
+        static_cast<double>(begin + 2), static_cast<double>(begin + 3));
+    __m256d maxIdx = index;
+    __m256d minIdx = index;
+    const __m256d step = _mm256_set1_pd(4.0);
+
+    size_t i = begin + 4;
+    for (; i + 4 <= end; i += 4) {
+        index = _mm256_add_pd(index, step);
+        __m256d v = _mm256_loadu_pd(arr + i);
+        __m256d greater = _mm256_cmp_pd(v, maxVal, _CMP_GT_OQ);
+        __m256d less = _mm256_cmp_pd(v, minVal, _CMP_LT_OQ);
+        maxVal = _mm256_blendv_pd(maxVal, v, greater);
+        maxIdx = _mm256_blendv_pd(maxIdx, index, greater);
+        minVal = _mm256_blendv_pd(minVal, v, less);
+        minIdx = _mm256_blendv_pd(minIdx, index, less);
+    }
+
+    alignas(32) double maxLanes[4];
+    alignas(32) double minLanes[4];
+    _mm256_store_pd(maxLanes, maxIdx);
+    _mm256_store_pd(minLanes, minIdx);
+    ExtremesResult result = reduceExtremeLanes(arr, maxLanes, minLanes, 4);
+
+    // Хвост идёт после всех линий, поэтому строгие сравнения сохраняют первое вхождение
+    for (; i < end; i++) {
+        if (arr[i] > arr[result.maxIndex]) result.maxIndex = i;
+        if (arr[i] < arr[result.minIndex]) result.minIndex = i;
+    }
+    return result;
+}
+
+/**
+ * Поиск экстремумов AVX-512: 8 линий, маски сравнений вместо blendv
+ */
+INCOME_TARGET("avx512f")
+ExtremesResult extremesAvx512(const double* arr, size_t begin, size_t end) {
+    if (end - begin < 16) {
+        return extremesScalar(arr, begin, end);
+    }
+
+    __m512d maxVal = _mm512_loadu_pd(arr + begin);
+    __m512d minVal = maxVal;
+    __m512d index = _mm512_add_pd(_mm512_set1_pd(static_cast<double>(begin)),
+        _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0));
+    __m512d maxIdx = index;
+    __m512d minIdx = index;
+    const __m512d step = _mm512_set1_pd(8.0);
+
+    size_t i = begin + 8;
+    for (; i + 8 <= end; i += 8) {
+        index = _mm512_add_pd(index, step);
+        __m512d v = _mm512_loadu_pd(arr + i);
+        __mmask8 greater = _mm512_cmp_pd_mask(v, maxVal, _CMP_GT_OQ);
+        __mmask8 less = _mm512_cmp_pd_mask(v, minVal, _CMP_LT_OQ);
+        maxVal = _mm512_mask_blend_pd(greater, maxVal, v);
+        maxIdx = _mm512_mask_blend_pd(greater, maxIdx, index);
+        minVal = _mm512_mask_blend_pd(less, minVal, v);
+        minIdx = _mm512_mask_blend_pd(less, minIdx, index);
+    }
+
+    alignas(64) double maxLanes[8];
+    alignas(64) double minLanes[8];
+    _mm512_store_pd(maxLanes, maxIdx);
+    _mm512_store_pd(minLanes, minIdx);
+    ExtremesResult result = reduceExtremeLanes(arr, maxLanes, minLanes, 8);
+
+    for (; i < end; i++) {
+        if (arr[i] > arr[result.maxIndex]) result.maxIndex = i;
+        if (arr[i] < arr[result.minIndex]) result.minIndex = i;
+    }
+    return result;
+}
+
+/**
+ * Проверка поддержки набора инструкций процессором и операционной системой
+ *
+ * @param avx512 true - проверить AVX-512F, false - AVX2.
+ */
+bool cpuSupports(bool avx512) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    unsigned long long xcr = osxsave ? _xgetbv(0) : 0;
+    __cpuidex(info, 7, 0);
+    if (avx512) {
+        return (xcr & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0;
+    }
+    return (xcr & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+#else
+    return avx512 ? __builtin_cpu_supports("avx512f") : __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+/**
+ * Ядро поиска экстремумов на участке массива
+ */
+using ExtremesKernel = ExtremesResult(*)(const double* arr, size_t begin, size_t end);
+
+/**
+ * Выбор самого широкого доступного ядра (выполняется один раз)
+ */
+ExtremesKernel activeExtremesKernel() {
+#ifdef INCOME_X86
+    static const ExtremesKernel kernel = cpuSupports(true) ? extremesAvx512
+        : cpuSupports(false) ? extremesAvx2 : extremesScalar;
+#else
+    static const ExtremesKernel kernel = extremesScalar;
+#endif
+    return kernel;
+}
+
+/**
+ * Поиск месяцев с максимальным и минимальным доходом
+ *
+ * Массив делится между потоками на непрерывные участки; результаты участков
+ * сливаются по порядку, поэтому при равных доходах выбирается первый месяц.
+ *
+ * @param arr указатель на массив.
+ * @param N размер массива.
+ * @param maxMonth ссылка для сохранения номера месяца с максимальным доходом.
+ * @param minMonth ссылка для сохранения номера месяца с минимальным доходом.
+ * @param threads количество потоков.
+ */
+void findExtremes(const double* arr, size_t N, size_t& maxMonth, size_t& minMonth, unsigned threads = 1) {
+    maxMonth = minMonth = 0;
+    if (N == 0) {
+        return;
+    }
+
+    size_t count = N;
+    size_t workers = std::max<size_t>(1, std::min<size_t>(threads, count));
+    size_t chunk = (count + workers - 1) / workers;
+    std::vector<ExtremesResult> partials(workers);
+    ExtremesKernel kernel = activeExtremesKernel();
+    runWorkers(workers, [&](size_t w) {
+        size_t begin = std::min(count, w * chunk);
+        size_t end = std::min(count, begin + chunk);
+        partials[w] = begin < end ? kernel(arr, begin, end) : ExtremesResult{ begin - 1, begin - 1 };
+    });
+
+    ExtremesResult total = partials[0];
+    for (size_t w = 1; w < workers; w++) {
+        mergeExtremes(arr, total, partials[w]);
+    }
+    maxMonth = total.maxIndex;
+    minMonth = total.minIndex;
+}
+
+/**
+ * Накопитель статистики доходов за один проход
+ *
+ * Хранит количество, среднее, сумму квадратов отклонений (M2), минимум и
+ * максимум. Блоки суммируются двухпроходно внутри кэша и вливаются по формуле
+ * Чана; накопители разных потоков или частей данных сливаются так же.
+ */
+struct IncomeStats {
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    /**
+     * Учёт одного значения (обновление Уэлфорда)
+     *
+     * @param value значение.
+     */
+    void add(double value) {
+        count++;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+    }
+
+    /**
+     * Слияние с другим накопителем (формула Чана)
+     *
+     * @param other накопитель другой части данных.
+     */
+    void merge(const IncomeStats& other) {
+        if (other.count == 0) {
+            return;
+        }
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        size_t total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+        count = total;
+        min = other.min < min ? other.min : min;
+        max = other.max > max ? other.max : max;
+    }
+
+    /**
+     * Учёт блока значений: среднее и M2 блока считаются по самому блоку
+     * (он уже в кэше), затем блок вливается в накопитель
+     *
+     * @param data указатель на блок.
+     * @param size размер блока.
+     */
+    void addBlock(const double* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        IncomeStats block;
+        block.count = size;
+
+        double sum = 0.0;
+        double low = data[0];
+        double high = data[0];
+        for (size_t i = 0; i < size; i++) {
+            sum += data[i];
+            low = data[i] < low ? data[i] : low;
+            high = data[i] > high ? data[i] : high;
+        }
+        block.mean = sum / size;
+        block.min = low;
+        block.max = high;
+
+        double squares = 0.0;
+        for (size_t i = 0; i < size; i++) {
+            double deviation = data[i] - block.mean;
+            squares += deviation * deviation;
+        }
+        block.m2 = squares;
+
+        merge(block);
+    }
+
+    double variance() const { return count > 0 ? m2 / count : 0.0; }
+    double standardDeviation() const { return std::sqrt(variance()); }
+};
+
+/**
+ * Накопление статистики по участку массива блоками, помещающимися в кэш
+ *
+ * @param arr указатель на массив.
+ * @param begin первый элемент участка.
+ * @param end элемент за последним.
+ * @return возвращает накопитель участка.
+ */
+IncomeStats accumulateRange(const double* arr, size_t begin, size_t end) {
+    const size_t BLOCK = 4096;
+    IncomeStats stats;
+    for (size_t start = begin; start < end; start += BLOCK) {
+        stats.addBlock(arr + start, std::min(BLOCK, end - start));
+    }
+    return stats;
+}
+
+/**
+ * Статистика массива доходов за один проход (параллельно)
+ *
+ * @param arr указатель на массив.
+ * @param N размер массива.
+ * @param threads количество потоков.
+ * @return возвращает среднее, дисперсию, минимум и максимум.
+ */
+IncomeStats computeIncomeStats(const double* arr, size_t N, unsigned threads = 1) {
+    size_t workers = std::max<size_t>(1, std::min<size_t>(threads, N));
+    size_t chunk = (N + workers - 1) / workers;
+    std::vector<IncomeStats> partials(workers);
+    runWorkers(workers, [&](size_t w) {
+        size_t begin = std::min(N, w * chunk);
+        size_t end = std::min(N, begin + chunk);
+        partials[w] = accumulateRange(arr, begin, end);
+    });
+
+    IncomeStats total;
+    for (const IncomeStats& partial : partials) {
+        total.merge(partial);
+    }
+    return total;
+}
+
+/**
+ * Параллельная поразрядная (LSD) сортировка массивов double
+ *
+ * Каждое число переводится в 64-битный ключ, порядок которого как у
+ * беззнаковых целых совпадает с порядком чисел (у отрицательных инвертируются
+ * все биты, у неотрицательных - знаковый). Ключи сортируются 8 проходами по
+ * 8 бит с параллельными гистограммой и раскладкой; проход пропускается, если
+ * все ключи имеют в нём одинаковую цифру. NaN переносятся в конец массива.
+ * Вспомогательный буфер хранится в объекте и переиспользуется между вызовами.
+ */
+class RadixSorter {
+private:
+    static const int DIGIT_BITS = 8;
+    static const size_t BUCKETS = size_t(1) << DIGIT_BITS;
+    static const int PASSES = 64 / DIGIT_BITS;
+
+    unsigned threads_;
+    std::vector<uint64_t> scratch_;
+
+    static uint64_t toKey(uint64_t bits) {
+        return (bits & 0x8000000000000000ull) ? ~bits : bits | 0x8000000000000000ull;
+    }
+
+    static uint64_t fromKey(uint64_t key) {
+        return (key & 0x8000000000000000ull) ? key & 0x7FFFFFFFFFFFFFFFull : ~key;
+    }
+
+    static size_t digit(uint64_t key, int pass) {
+        return static_cast<size_t>(key >> (pass * DIGIT_BITS)) & (BUCKETS - 1);
+    }
+
+    // Ключи лежат то в массиве double, то в буфере uint64_t, поэтому
+    // читаются и пишутся только через memcpy (без нарушения строгого алиасинга)
+    static uint64_t loadKey(const unsigned char* keys, size_t i) {
+        uint64_t key;
+        std::memcpy(&key, keys + i * sizeof(key), sizeof(key));
+        return key;
+    }
+
+    static void storeKey(unsigned char* keys, size_t i, uint64_t key) {
+        std::memcpy(keys + i * sizeof(key), &key, sizeof(key));
+    }
+
+public:
+    explicit RadixSorter(unsigned threads = 1) : threads_(threads == 0 ? 1 : threads) {}
+
+    /**
+     * Освобождение вспомогательного буфера (следующая сортировка выделит его заново)
+     */
+    void releaseScratch() {
+        scratch_.clear();
+        scratch_.shrink_to_fit();
+    }
+
+    /**
+     * Сортировка массива по возрастанию на месте
+     *
+     * @param arr указатель на массив.
+     * @param N размер массива.
+     */
+    void sort(double* arr, size_t N) {
+        // NaN не упорядочены - переносим их в конец и сортируем остальное
+        size_t n = static_cast<size_t>(std::partition(arr, arr + N, [](double x) { return !std::isnan(x); }) - arr);
+        if (n < 2) {
+            return;
+        }
+
+        if (scratch_.size() < n) {
+            scratch_.resize(n);
+        }
+        size_t workers = std::max<size_t>(1, std::min<size_t>(threads_, n / 4096 + 1));
+        size_t chunk = (n + workers - 1) / workers;
+
+        // Ключи записываются поверх исходного массива, который дальше
+        // рассматривается только как байты
+        unsigned char* keys = reinterpret_cast<unsigned char*>(arr);
+        std::vector<std::array<size_t, BUCKETS * PASSES>> totals(workers);
+        runWorkers(workers, [&](size_t w) {
+            std::array<size_t, BUCKETS * PASSES>& count = totals[w];
+            count.fill(0);
+            size_t begin = std::min(n, w * chunk);
+            size_t end = std::min(n, begin + chunk);
+            for (size_t i = begin; i < end; i++) {
+                uint64_t key = toKey(loadKey(keys, i));
+                storeKey(keys, i, key);
+                for (int pass = 0; pass < PASSES; pass++) {
+                    count[pass * BUCKETS + digit(key, pass)]++;
+                }
+            }
+        });
+
+        unsigned char* src = keys;
+        unsigned char* dst = reinterpret_cast<unsigned char*>(scratch_.data());
+        std::vector<std::array<size_t, BUCKETS>> offsets(workers);
+
+        for (int pass = 0; pass < PASSES; pass++) {
+            // Проход не нужен, если все ключи попадают в одну корзину
+            bool trivial = false;
+            for (size_t d = 0; d < BUCKETS; d++) {
+                size_t total = 0;
+                for (size_t w = 0; w < workers; w++) {
+                    total += totals[w][pass * BUCKETS + d];
+                }
+                if (total == n) {
+                    trivial = true;
+                    break;
+                }
+                if (total != 0) {
+                    break;
+                }
+            }
+            if (trivial) {
+                continue;
+            }
+
+            // Гистограммы участков в текущем порядке данных
+            runWorkers(workers, [&](size_t w) {
+                std::array<size_t, BUCKETS>& count = offsets[w];
+                count.fill(0);
+                size_t begin = std::min(n, w * chunk);
+                size_t end = std::min(n, begin + chunk);
+                for (size_t i = begin; i < end; i++) {
+                    count[digit(loadKey(src, i), pass)]++;
+                }
+            });
+
+            // Смещения: цифра - старший ключ, номер участка - младший (устойчивость)
+            size_t position = 0;
+            for (size_t d = 0; d < BUCKETS; d++) {
+                for (size_t w = 0; w < workers; w++) {
+                    size_t count = offsets[w][d];
+                    offsets[w][d] = position;
+                    position += count;
+                }
+            }
+
+            runWorkers(workers, [&](size_t w) {
+                std::array<size_t, BUCKETS>& offset = offsets[w];
+                size_t begin = std::min(n, w * chunk);
+                size_t end = std::min(n, begin + chunk);
+                for (size_t i = begin; i < end; i++) {
+                    uint64_t key = loadKey(src, i);
+                    storeKey(dst, offset[digit(key, pass)]++, key);
+                }
+            });
+            std::swap(src, dst);
+        }
+
+        // Обратное преобразование ключей в числа (с переносом из буфера, если нужно)
+        runWorkers(workers, [&](size_t w) {
+            size_t begin = std::min(n, w * chunk);
+            size_t end = std::min(n, begin + chunk);
+            for (size_t i = begin; i < end; i++) {
+                storeKey(keys, i, fromKey(loadKey(src, i)));
+            }
+        });
+    }
+};
+
+/**
+ * Сортировка массива по возрастанию (передача по указателю)
+ *
+ * @param arr указатель на массив.
+ * @param N размер массива.
+ * @param sorter поразрядная сортировка с переиспользуемым буфером.
+ */
+void sortArrayPointer(double* arr, size_t N, RadixSorter& sorter) {
+    sorter.sort(arr, N);
+}
+
+/**
+ * Создание отсортированной копии массива (передача по значению)
+ *
+ * @param arr копия массива.
+ * @param N размер массива.
+ * @param sorter поразрядная сортировка с переиспользуемым буфером.
+ * @return возвращает отсортированную копию массива.
+ */
+double* sortArrayValue(const double arr[], size_t N, RadixSorter& sorter) {
+    double* sortedArr = new double[N];
+    // Копируем данные из исходного массива
+    std::memcpy(sortedArr, arr, N * sizeof(double));
+    // Сортируем копию массива
+    sorter.sort(sortedArr, N);
+    return sortedArr; // Возвращаем указатель на отсортированную копию
+}
+
+/**
+ * Точные квантили выбором (без полной сортировки)
+ *
+ * Данные копируются в рабочий буфер (NaN отбрасываются), затем для каждой
+ * запрошенной доли nth_element ставит на место нужные порядковые статистики;
+ * доли обрабатываются по возрастанию, так что каждый следующий выбор идёт
+ * только по правой части буфера. Между соседними статистиками значение
+ * интерполируется линейно (позиция q * (n - 1)).
+ *
+ * @param arr указатель на массив.
+ * @param N размер массива.
+ * @param fractions доли из [0, 1].
+ * @param scratch рабочий буфер (переиспользуется между вызовами).
+ * @return возвращает квантили в порядке запрошенных долей.
+ */
+std::vector<double> exactQuantiles(const double* arr, size_t N, const std::vector<double>& fractions,
+    std::vector<double>& scratch) {
+    scratch.clear();
+    scratch.reserve(N);
+    std::remove_copy_if(arr, arr + N, std::back_inserter(scratch), [](double x) { return std::isnan(x); });
+    size_t n = scratch.size();
+
+    std::vector<size_t> order(fractions.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        if (!(fractions[i] >= 0.0 && fractions[i] <= 1.0)) {
+            throw std::invalid_argument("Error: quantile fraction must be in [0, 1].");
+        }
+        order[i] = i;
+    }
+    std::vector<double> result(fractions.size(), std::numeric_limits<double>::quiet_NaN());
+    if (n == 0) {
+        return result;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return fractions[a] < fractions[b]; });
+
+    size_t done = 0; // Элементы левее done уже на своих местах и не больше правых
+    for (size_t i : order) {
+        double position = fractions[i] * (n - 1);
+        size_t lower = static_cast<size_t>(position);
+        if (lower >= done) {
+            std::nth_element(scratch.begin() + done, scratch.begin() + lower, scratch.end());
+            done = lower;
+        }
+        double value = scratch[lower];
+        double weight = position - lower;
+        if (weight > 0.0 && lower + 1 < n) {
+            // Следующая статистика - минимум правой части после выбора
+            double next = *std::min_element(scratch.begin() + lower + 1, scratch.end());
+            value += weight * (next - value);
+        }
+        result[i] = value;
+    }
+    return result;
+}
+
+/**
+ * Приближённые квантили в потоке данных: скетч KLL
+ *
+ * Значения хранятся уровнями; элемент уровня h представляет 2^h исходных.
+ * Переполненный уровень сортируется, и каждый второй элемент (случайная
+ * чётность) переносится на уровень выше. Ёмкость уровней убывает
+ * геометрически вниз от верхнего, поэтому память - O(k) при любом объёме
+ * потока, а ошибка ранга - порядка 1/k. Скетчи частей данных сливаются
+ * объединением уровней с последующим сжатием.
+ */
+class QuantileSketch {
+private:
+    size_t k_;
+    uint64_t count_ = 0;
+    uint64_t random_;
+    size_t retained_ = 0;      // Хранимых значений на всех уровнях
+    size_t totalCapacity_ = 0; // Суммарная ёмкость уровней
+    std::vector<std::vector<double>> levels_;
+    std::vector<size_t> capacities_; // Ёмкости уровней (зависят только от числа уровней)
+
+    void resizeLevels(size_t count) {
+        levels_.resize(count);
+        capacities_.resize(count);
+        totalCapacity_ = 0;
+        for (size_t h = 0; h < count; h++) {
+            size_t depth = count - 1 - h;
+            capacities_[h] = std::max<size_t>(2, static_cast<size_t>(k_ * std::pow(2.0 / 3.0, static_cast<double>(depth))) + 1);
+            totalCapacity_ += capacities_[h];
+        }
+    }
+
+    bool randomBit() {
+        // xorshift64: для выбора чётности достаточно
+        random_ ^= random_ << 13;
+        random_ ^= random_ >> 7;
+        random_ ^= random_ << 17;
+        return (random_ & 1) != 0;
+    }
+
+    void compress() {
+        while (retained_ >= totalCapacity_) {
+            size_t h = 0;
+            while (levels_[h].size() < capacities_[h]) {
+                h++;
+            }
+            if (h + 1 == levels_.size()) {
+                resizeLevels(levels_.size() + 1);
+            }
+            std::vector<double>& level = levels_[h];
+            std::sort(level.begin(), level.end());
+
+            // При нечётном размере один элемент остаётся на уровне
+            double leftover = 0.0;
+            bool odd = (level.size() % 2) != 0;
+            if (odd) {
+                leftover = level.back();
+                level.pop_back();
+            }
+            std::vector<double>& upper = levels_[h + 1];
+            for (size_t i = randomBit() ? 1 : 0; i < level.size(); i += 2) {
+                upper.push_back(level[i]);
+            }
+            retained_ -= level.size() / 2;
+            level.clear();
+            if (odd) {
+                level.push_back(leftover);
+            }
+        }
+    }
+
+public:
+    explicit QuantileSketch(size_t k = 200, uint64_t seed = 0x9E3779B97F4A7C15ull)
+        : k_(std::max<size_t>(k, 8)), random_(seed | 1) {
+        resizeLevels(1);
+    }
+
+    /**
+     * Учёт одного значения (NaN пропускаются)
+     */
+    void add(double value) {
+        if (std::isnan(value)) {
+            return;
+        }
+        count_++;
+        retained_++;
+        levels_[0].push_back(value);
+        if (retained_ >= totalCapacity_) {
+            compress();
+        }
+    }
+
+    /**
+     * Слияние со скетчем другой части данных
+     */
+    void merge(const QuantileSketch& other) {
+        if (other.levels_.size() > levels_.size()) {
+            resizeLevels(other.levels_.size());
+        }
+        for (size_t h = 0; h < other.levels_.size(); h++) {
+            levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+        }
+        count_ += other.count_;
+        retained_ += other.retained_;
+        compress();
+    }
+
+    uint64_t count() const {
+        return count_;
+    }
+
+    /**
+     * Приближённые квантили по накопленным данным
+     *
+     * @param fractions доли из [0, 1].
+     * @return возвращает квантили в порядке запрошенных долей.
+     */
+    std::vector<double> quantiles(const std::vector<double>& fractions) const {
+        std::vector<std::pair<double, uint64_t>> weighted;
+        weighted.reserve(retained_);
+        for (size_t h = 0; h < levels_.size(); h++) {
+            for (double value : levels_[h]) {
+                weighted.emplace_back(value, uint64_t(1) << h);
+            }
+        }
+        std::sort(weighted.begin(), weighted.end());
+        uint64_t total = 0;
+        for (const std::pair<double, uint64_t>& item : weighted) {
+            total += item.second;
+        }
+
+        std::vector<double> result;
+        result.reserve(fractions.size());
+        for (double q : fractions) {
+            if (!(q >= 0.0 && q <= 1.0)) {
+                throw std::invalid_argument("Error: quantile fraction must be in [0, 1].");
+            }
+            if (weighted.empty()) {
+                result.push_back(std::numeric_limits<double>::quiet_NaN());
+                continue;
+            }
+            // Позиция ранга q * (total - 1), как в exactQuantiles: элемент веса w
+            // занимает w соседних рангов, между рангами значение интерполируется
+            // линейно, поэтому при единичных весах ответ совпадает с точным
+            double target = q * static_cast<double>(total - 1);
+            uint64_t lower = static_cast<uint64_t>(target);
+            double fraction = target - static_cast<double>(lower);
+            uint64_t cumulative = 0;
+            size_t i = 0;
+            while (i + 1 < weighted.size() && cumulative + weighted[i].second <= lower) {
+                cumulative += weighted[i].second;
+                i++;
+            }
+            double value = weighted[i].first;
+            if (fraction > 0.0 && cumulative + weighted[i].second == lower + 1 && i + 1 < weighted.size()) {
+                // Следующий ранг принадлежит уже следующему элементу
+                value += fraction * (weighted[i + 1].first - value);
+            }
+            result.push_back(value);
+        }
+        return result;
+    }
+};
+
+/**
+ * Построение скетча квантилей по массиву (скетчи потоков сливаются)
+ *
+ * @param arr указатель на массив.
+ * @param N размер массива.
+ * @param threads количество потоков.
+ * @param k точность скетча.
+ * @return возвращает скетч всего массива.
+ */
+QuantileSketch buildQuantileSketch(const double* arr, size_t N, unsigned threads = 1, size_t k = 200) {
+    size_t workers = std::max<size_t>(1, std::min<size_t>(threads, N / 4096 + 1));
+    size_t chunk = (N + workers - 1) / workers;
+    std::vector<QuantileSketch> partials;
+    for (size_t w = 0; w < workers; w++) {
+        partials.emplace_back(k, 0x9E3779B97F4A7C15ull + w);
+    }
+    runWorkers(workers, [&](size_t w) {
+        size_t begin = std::min(N, w * chunk);
+        size_t end = std::min(N, begin + chunk);
+        for (size_t i = begin; i < end; i++) {
+            partials[w].add(arr[i]);
+        }
+    });
+    for (size_t w = 1; w < workers; w++) {
+        partials[0].merge(partials[w]);
+    }
+    return partials[0];
+}
+
+/**
+ * Статистика одного окна скользящего ряда
+ */
+struct RollingPoint {
+    double mean;
+    double standardDeviation;
+    double min;
+    double max;
+};
+
+/**
+ * Скользящее окно фиксированной длины с обновлением за O(1)
+ *
+ * Значения окна хранятся в кольцевом буфере. Среднее и M2 при замене
+ * старого значения новым пересчитываются по формуле Уэлфорда для
+ * сдвига окна; раз в window шагов они пересчитываются по буферу заново
+ * двухпроходно, чтобы ошибка округления не накапливалась на длинных рядах
+ * (амортизированно это тоже O(1)). Минимум и максимум ведутся монотонными
+ * очередями номеров (амортизированно O(1) на шаг). Окно работает в потоке: данные целиком
+ * в памяти не нужны.
+ */
+class RollingWindow {
+private:
+    size_t window_;
+    uint64_t position_ = 0; // Номер следующего значения
+    std::vector<double> ring_;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    std::deque<uint64_t> maxQueue_; // Номера со строго убывающими значениями
+    std::deque<uint64_t> minQueue_; // Номера со строго возрастающими значениями
+
+    double at(uint64_t index) const {
+        return ring_[index % window_];
+    }
+
+public:
+    explicit RollingWindow(size_t window) : window_(window), ring_(window) {
+        if (window == 0) {
+            throw std::invalid_argument("Error: window length must be positive.");
+        }
+    }
+
+    /**
+     * Добавление значения (самое старое уходит, если окно заполнено)
+     *
+     * @param value новое значение.
+     */
+    void push(double value) {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(position_, window_));
+        if (count < window_) {
+            double delta = value - mean_;
+            mean_ += delta / (count + 1);
+            m2_ += delta * (value - mean_);
+        }
+        else {
+            double old = at(position_);
+            double oldMean = mean_;
+            mean_ += (value - old) / window_;
+            m2_ += (value - old) * (value - mean_ + old - oldMean);
+            m2_ = m2_ > 0.0 ? m2_ : 0.0;
+        }
+        ring_[position_ % window_] = value;
+
+        if (count == window_ && (position_ + 1) % window_ == 0) {
+            double sum = 0.0;
+            for (double x : ring_) {
+                sum += x;
+            }
+            mean_ = sum / window_;
+            double squares = 0.0;
+            for (double x : ring_) {
+                squares += (x - mean_) * (x - mean_);
+            }
+            m2_ = squares;
+        }
+
+        while (!maxQueue_.empty() && at(maxQueue_.back()) <= value) {
+            maxQueue_.pop_back();
+        }
+        maxQueue_.push_back(position_);
+        while (!minQueue_.empty() && at(minQueue_.back()) >= value) {
+            minQueue_.pop_back();
+        }
+        minQueue_.push_back(position_);
+
+        position_++;
+        // Номера, вышедшие за окно, удаляются с головы очередей
+        uint64_t first = position_ > window_ ? position_ - window_ : 0;
+        if (maxQueue_.front() < first) {
+            maxQueue_.pop_front();
+        }
+        if (minQueue_.front() < first) {
+            minQueue_.pop_front();
+        }
+    }
+
+    bool full() const {
+        return position_ >= window_;
+    }
+
+    /**
+     * Статистика текущего окна
+     */
+    RollingPoint current() const {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(position_, window_));
+        RollingPoint point;
+        point.mean = mean_;
+        point.standardDeviation = count > 0 ? std::sqrt(m2_ / count) : 0.0;
+        point.min = minQueue_.empty() ? mean_ : at(minQueue_.front());
+        point.max = maxQueue_.empty() ? mean_ : at(maxQueue_.front());
+        return point;
+    }
+};
+
+/**
+ * Двоичный файл доходов: заголовок из 16 байт (сигнатура "INCB", версия,
+ * количество месяцев, little-endian), за ним значения double подряд
+ */
+const char INCOME_BINARY_MAGIC[4] = { 'I', 'N', 'C', 'B' };
+const uint32_t INCOME_BINARY_VERSION = 1;
+
+struct IncomeFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+};
+
+// Элементов в участке при обходе отображённого файла (64 МБ)
+const size_t INCOME_CHUNK_ELEMENTS = size_t(1) << 23;
+// Элементов в отсортированной серии внешней сортировки (512 МБ)
+const size_t INCOME_RUN_ELEMENTS = size_t(1) << 26;
+
+/**
+ * Сохранение доходов в двоичный файл
+ *
+ * @param path путь к файлу.
+ * @param arr указатель на массив.
+ * @param N размер массива.
+ */
+void saveIncomeBinary(const std::string& path, const double* arr, size_t N) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Error: cannot create file '" + path + "'.");
+    }
+    IncomeFileHeader header;
+    std::memcpy(header.magic, INCOME_BINARY_MAGIC, sizeof(header.magic));
+    header.version = INCOME_BINARY_VERSION;
+    header.count = N;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(arr), static_cast<std::streamsize>(N * sizeof(double)));
+    if (!out) {
+        throw std::runtime_error("Error: cannot write file '" + path + "'.");
+    }
+}
+
+/**
+ * Двоичный файл доходов, отображённый в память только для чтения
+ *
+ * Файл не загружается целиком: страницы подгружаются при обращении, а
+ * обход участками сопровождается подсказками ядру - следующий участок
+ * запрашивается заранее (readahead), пройденный отдаётся обратно, так что
+ * резидентная часть остаётся порядка двух участков при любом размере файла.
+ */
+class MappedIncomeFile {
+private:
+    const char* base_ = nullptr;
+    size_t mappedSize_ = 0;
+    const double* data_ = nullptr;
+    size_t count_ = 0;
+    size_t page_ = 4096;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+
+    // Границы участка элементов, выровненные по страницам
+    std::pair<char*, size_t> pages(size_t begin, size_t end) const {
+        const char* first = reinterpret_cast<const char*>(data_ + begin);
+        const char* last = reinterpret_cast<const char*>(data_ + end);
+        size_t shift = static_cast<size_t>(first - base_) % page_;
+        return { const_cast<char*>(first - shift), static_cast<size_t>(last - first) + shift };
+    }
+
+public:
+    explicit MappedIncomeFile(const std::string& path) {
+        uint64_t fileSize = 0;
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Error: cannot open file '" + path + "'.");
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size)) {
+            CloseHandle(file_);
+            throw std::runtime_error("Error: cannot stat file '" + path + "'.");
+        }
+        fileSize = static_cast<uint64_t>(size.QuadPart);
+        SYSTEM_INFO system;
+        GetSystemInfo(&system);
+        page_ = system.dwPageSize;
+        if (fileSize > 0) {
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_ != nullptr) {
+                base_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            }
+            if (base_ == nullptr) {
+                if (mapping_ != nullptr) CloseHandle(mapping_);
+                CloseHandle(file_);
+                throw std::runtime_error("Error: cannot map file '" + path + "'.");
+            }
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Error: cannot open file '" + path + "'.");
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("Error: cannot stat file '" + path + "'.");
+        }
+        fileSize = static_cast<uint64_t>(info.st_size);
+        page_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        if (fileSize > 0) {
+            void* mapped = mmap(nullptr, static_cast<size_t>(fileSize), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Error: cannot map file '" + path + "'.");
+            }
+            madvise(mapped, static_cast<size_t>(fileSize), MADV_SEQUENTIAL);
+            base_ = static_cast<const char*>(mapped);
+        }
+        close(fd);
+#endif
+        mappedSize_ = static_cast<size_t>(fileSize);
+
+        IncomeFileHeader header;
+        if (mappedSize_ < sizeof(header)) {
+            release();
+            throw std::runtime_error("Error: '" + path + "' is not an income binary file.");
+        }
+        std::memcpy(&header, base_, sizeof(header));
+        if (std::memcmp(header.magic, INCOME_BINARY_MAGIC, sizeof(header.magic)) != 0
+            || header.version != INCOME_BINARY_VERSION) {
+            release();
+            throw std::runtime_error("Error: '" + path + "' is not an income binary file.");
+        }
+        if (header.count > (mappedSize_ - sizeof(header)) / sizeof(double)) {
+            release();
+            throw std::runtime_error("Error: '" + path + "' is truncated.");
+        }
+        count_ = static_cast<size_t>(header.count);
+        data_ = reinterpret_cast<const double*>(base_ + sizeof(header));
+    }
+
+    ~MappedIncomeFile() {
+        release();
+    }
+
+    MappedIncomeFile(const MappedIncomeFile&) = delete;
+    MappedIncomeFile& operator=(const MappedIncomeFile&) = delete;
+
+    void release() {
+#if defined(_WIN32)
+        if (base_ != nullptr) UnmapViewOfFile(base_);
+        if (mapping_ != nullptr) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (base_ != nullptr) munmap(const_cast<char*>(base_), mappedSize_);
+#endif
+        base_ = nullptr;
+    }
+
+    const double* data() const { return data_; }
+    size_t size() const { return count_; }
+
+    /**
+     * Подсказка: участок [begin, end) скоро понадобится (упреждающее чтение)
+     */
+    void prefetch(size_t begin, size_t end) const {
+        if (begin >= end) {
+            return;
+        }
+        std::pair<char*, size_t> range = pages(begin, end);
+#if defined(_WIN32)
+        WIN32_MEMORY_RANGE_ENTRY entry = { range.first, range.second };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+#else
+        madvise(range.first, range.second, MADV_WILLNEED);
+#endif
+    }
+
+    /**
+     * Подсказка: участок [begin, end) пройден, его страницы можно вытеснить
+     */
+    void evict(size_t begin, size_t end) const {
+        if (begin >= end) {
+            return;
+        }
+        std::pair<char*, size_t> range = pages(begin, end);
+#if defined(_WIN32)
+        // Для незаблокированных страниц снимает их с рабочего набора процесса
+        VirtualUnlock(range.first, range.second);
+#else
+        madvise(range.first, range.second, MADV_DONTNEED);
+#endif
+    }
+};
 
 /**
- * Заполнение массива случайными числами в заданном диапазоне
+ * Набор помесячных доходов с отложенно строящимся отсортированным представлением
  *
- * @param arr указатель на массив.
- * @param N размер массива.
- * @param min минимальное значение.
- * @param max максимальное значение.
+ * Данные либо хранятся в памяти (сгенерированный ряд), либо отображаются из
+ * двоичного файла только для чтения; в последнем случае ряд может быть
+ * больше оперативной памяти, и операции проходят его участками.
+ *
+ * Отсортированная копия (только для данных в памяти) строится при первом
+ * запросе и хранится до изменения данных; повторные отсортированные чтения
+ * и запросы порядковых статистик после этого выполняются за O(1). Данные
+ * меняются только через fill и set, и каждое изменение сбрасывает кэш.
  */
-void fillArray(double* arr, int N, double min, double max) {
-    for (int i = 0; i < N; i++) {
-        arr[i] = min + static_cast<double>(rand()) / RAND_MAX * (max - min);
+class IncomeData {
+private:
+    std::vector<double> values_;
+    std::unique_ptr<MappedIncomeFile> file_;
+    std::vector<double> sorted_;
+    bool sortedValid_ = false;
+    RadixSorter sorter_;
+
+    void requireInMemory() const {
+        if (file_) {
+            throw std::logic_error("Error: file-backed income data is read-only.");
+        }
+    }
+
+    /**
+     * Доступ к данным на запись (отсортированное представление сбрасывается)
+     *
+     * Закрыт, чтобы указатель не пережил следующий sorted(): снаружи данные
+     * меняются только через fill и set.
+     */
+    double* mutableData() {
+        requireInMemory();
+        sortedValid_ = false;
+        return values_.data();
+    }
+
+public:
+    explicit IncomeData(size_t N, unsigned threads = 1) : values_(N), sorter_(threads) {}
+
+    /**
+     * Набор из двоичного файла доходов (отображается, а не загружается)
+     */
+    IncomeData(const std::string& path, unsigned threads)
+        : file_(new MappedIncomeFile(path)), sorter_(threads) {}
+
+    bool mapped() const {
+        return file_ != nullptr;
+    }
+
+    size_t size() const {
+        return file_ ? file_->size() : values_.size();
+    }
+
+    const double* data() const {
+        return file_ ? file_->data() : values_.data();
+    }
+
+    double operator[](size_t i) const {
+        return data()[i];
+    }
+
+    /**
+     * Обход участка [first, last) частями: fn(указатель на часть, номер первого элемента, размер)
+     *
+     * Для отображённого файла следующая часть запрашивается заранее, а
+     * пройденная отдаётся системе; данные в памяти обходятся целиком.
+     */
+    template <typename Fn>
+    void forEachChunk(size_t first, size_t last, const Fn& fn, size_t chunkElements = INCOME_CHUNK_ELEMENTS) const {
+        last = std::min(last, size());
+        if (first >= last) {
+            return;
+        }
+        if (!file_) {
+            fn(values_.data() + first, first, last - first);
+            return;
+        }
+        file_->prefetch(first, std::min(last, first + chunkElements));
+        for (size_t begin = first; begin < last; begin += chunkElements) {
+            size_t end = std::min(last, begin + chunkElements);
+            file_->prefetch(end, std::min(last, end + chunkElements));
+            fn(file_->data() + begin, begin, end - begin);
+            file_->evict(begin, end);
+        }
+    }
+
+    template <typename Fn>
+    void forEachChunk(const Fn& fn) const {
+        forEachChunk(0, size(), fn);
+    }
+
+    void set(size_t i, double value) {
+        requireInMemory();
+        sortedValid_ = false;
+        values_[i] = value;
+    }
+
+    /**
+     * Заполнение случайными данными (см. fillArray)
+     */
+    void fill(double min, double max, uint64_t seed, unsigned threads = 1) {
+        fillArray(mutableData(), values_.size(), min, max, seed, threads);
+    }
+
+    /**
+     * Отсортированное по возрастанию представление (строится при первом обращении)
+     */
+    const std::vector<double>& sorted() {
+        requireInMemory();
+        if (!sortedValid_) {
+            sorted_.assign(values_.begin(), values_.end());
+            sorter_.sort(sorted_.data(), sorted_.size());
+            sortedValid_ = true;
+        }
+        return sorted_;
+    }
+
+    /**
+     * k-я порядковая статистика (0 - минимум)
+     */
+    double kthSmallest(size_t k) {
+        const std::vector<double>& view = sorted();
+        if (k >= view.size()) {
+            throw std::out_of_range("Error: order statistic index is out of range.");
+        }
+        return view[k];
+    }
+
+    RadixSorter& sorter() {
+        return sorter_;
     }
+};
+
+/**
+ * Поиск месяцев с экстремальным доходом по всему набору (участками)
+ *
+ * @param income набор доходов.
+ * @param threads количество потоков.
+ * @return возвращает номера месяцев с максимальным и минимальным доходом.
+ */
+ExtremesResult findExtremes(const IncomeData& income, unsigned threads = 1) {
+    ExtremesResult total{ 0, 0 };
+    bool first = true;
+    income.forEachChunk([&](const double* chunk, size_t offset, size_t count) {
+        size_t maxMonth, minMonth;
+        findExtremes(chunk, count, maxMonth, minMonth, threads);
+        ExtremesResult next{ offset + maxMonth, offset + minMonth };
+        if (first) {
+            total = next;
+            first = false;
+        }
+        else {
+            mergeExtremes(income.data(), total, next);
+        }
+    });
+    return total;
 }
 
 /**
- * Поиск месяцев с максимальным и минимальным доходом
+ * Статистика всего набора доходов (участками)
  *
- * @param arr указатель на массив.
- * @param N размер массива.
- * @param maxMonth ссылка для сохранения номера месяца с максимальным доходом.
- * @param minMonth ссылка для сохранения номера месяца с минимальным доходом.
+ * @param income набор доходов.
+ * @param threads количество потоков.
+ * @return возвращает среднее, дисперсию, минимум и максимум.
  */
-void findExtremes(double* arr, int N, int& maxMonth, int& minMonth) {
-    maxMonth = minMonth = 0;
+IncomeStats computeIncomeStats(const IncomeData& income, unsigned threads = 1) {
+    IncomeStats total;
+    income.forEachChunk([&](const double* chunk, size_t, size_t count) {
+        total.merge(computeIncomeStats(chunk, count, threads));
+    });
+    return total;
+}
+
+/**
+ * Скетч квантилей всего набора доходов (участками)
+ *
+ * @param income набор доходов.
+ * @param threads количество потоков.
+ * @return возвращает скетч всего набора.
+ */
+QuantileSketch buildQuantileSketch(const IncomeData& income, unsigned threads = 1) {
+    QuantileSketch total;
+    income.forEachChunk([&](const double* chunk, size_t, size_t count) {
+        total.merge(buildQuantileSketch(chunk, count, threads));
+    });
+    return total;
+}
+
+/**
+ * Внешняя сортировка набора доходов в двоичный файл
+ *
+ * Данные разбиваются на серии по runElements значений; каждая серия
+ * сортируется поразрядно в памяти и записывается во временный файл, затем
+ * серии сливаются через кучу по их отображениям. На этапе серий в памяти
+ * одна серия и буфер поразрядной сортировки того же размера; затем буфер
+ * сортировки освобождается, и при слиянии остаётся только буфер записи,
+ * поэтому сортируются и ряды больше оперативной памяти. NaN, как и в
+ * RadixSorter, оказываются в конце. Временные файлы серий удаляются при
+ * любом исходе, в том числе при ошибке.
+ *
+ * @param income набор доходов.
+ * @param path путь к файлу результата.
+ * @param sorter поразрядная сортировка с переиспользуемым буфером.
+ * @param runElements размер серии.
+ */
+void sortIncomeToFile(const IncomeData& income, const std::string& path, RadixSorter& sorter,
+    size_t runElements = INCOME_RUN_ELEMENTS) {
+    // Временные файлы серий удаляются в деструкторе (после закрытия отображений)
+    struct RunFiles {
+        std::vector<std::string> paths;
+        ~RunFiles() {
+            for (const std::string& run : paths) {
+                std::remove(run.c_str());
+            }
+        }
+    };
+
+    size_t N = income.size();
+    runElements = std::max<size_t>(runElements, 1);
+    RunFiles runFiles;
+    std::vector<std::string>& runs = runFiles.paths;
+    std::vector<double> buffer;
+
+    // Серии: участки, отсортированные в памяти
+    for (size_t begin = 0; begin < N; begin += runElements) {
+        size_t count = std::min(runElements, N - begin);
+        buffer.resize(count);
+        income.forEachChunk(begin, begin + count, [&](const double* chunk, size_t offset, size_t size) {
+            std::memcpy(buffer.data() + (offset - begin), chunk, size * sizeof(double));
+        });
+        sorter.sort(buffer.data(), count);
+        if (N <= runElements) {
+            sorter.releaseScratch();
+            saveIncomeBinary(path, buffer.data(), count);
+            return;
+        }
+        runs.push_back(path + ".run" + std::to_string(runs.size()));
+        saveIncomeBinary(runs.back(), buffer.data(), count);
+    }
+    if (runs.empty()) {
+        saveIncomeBinary(path, nullptr, 0);
+        return;
+    }
+    buffer.clear();
+    buffer.shrink_to_fit();
+    sorter.releaseScratch();
+
+    // Слияние серий: в куче по одному текущему значению от каждой
+    std::vector<std::unique_ptr<MappedIncomeFile>> inputs;
+    for (const std::string& run : runs) {
+        inputs.emplace_back(new MappedIncomeFile(run));
+    }
+    std::vector<size_t> positions(inputs.size(), 0);
+    auto later = [&](size_t a, size_t b) {
+        // Порядок RadixSorter: числа по возрастанию, NaN в конце
+        double x = inputs[a]->data()[positions[a]];
+        double y = inputs[b]->data()[positions[b]];
+        if (std::isnan(x) != std::isnan(y)) {
+            return std::isnan(x);
+        }
+        return x > y || (!(x < y) && a > b);
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+    for (size_t r = 0; r < inputs.size(); r++) {
+        heap.push(r);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Error: cannot create file '" + path + "'.");
+    }
+    IncomeFileHeader header;
+    std::memcpy(header.magic, INCOME_BINARY_MAGIC, sizeof(header.magic));
+    header.version = INCOME_BINARY_VERSION;
+    header.count = N;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
-    for (int i = 1; i < N; i++) {
-        if (arr[i] > arr[maxMonth]) {
-            maxMonth = i;
+    const size_t OUTPUT_BLOCK = size_t(1) << 16;
+    std::vector<double> output;
+    output.reserve(OUTPUT_BLOCK);
+    while (!heap.empty()) {
+        size_t r = heap.top();
+        heap.pop();
+        output.push_back(inputs[r]->data()[positions[r]]);
+        if (++positions[r] < inputs[r]->size()) {
+            heap.push(r);
         }
-        if (arr[i] < arr[minMonth]) {
-            minMonth = i;
+        if (output.size() == OUTPUT_BLOCK || heap.empty()) {
+            out.write(reinterpret_cast<const char*>(output.data()),
+                static_cast<std::streamsize>(output.size() * sizeof(double)));
+            output.clear();
         }
     }
+    if (!out) {
+        throw std::runtime_error("Error: cannot write file '" + path + "'.");
+    }
 }
 
 /**
- * Вычисление среднегодового дохода
+ * Форматирование дохода через to_chars
  *
- * @param arr указатель на массив.
- * @param N размер массива.
- * @return возвращает среднее арифметическое значение массива.
+ * @param first начало буфера (не менее 32 символов).
+ * @param last конец буфера.
+ * @param value значение.
+ * @param roundTrip true - кратчайшая запись, читаемая обратно без потерь;
+ *        false - 6 значащих цифр, как у std::cout по умолчанию.
+ * @return возвращает указатель за последним записанным символом.
  */
-double calculateAverage(double* arr, int N) {
-    double sum = 0.0;
-    for (int i = 0; i < N; i++) {
-        sum += arr[i];
-    }
-    return sum / N;
+char* formatIncome(char* first, char* last, double value, bool roundTrip) {
+    std::to_chars_result result = roundTrip
+        ? std::to_chars(first, last, value)
+        : std::to_chars(first, last, value, std::chars_format::general, 6);
+    return result.ptr;
+}
+
+std::string formatIncome(double value, bool roundTrip) {
+    char text[32];
+    return std::string(text, formatIncome(text, text + sizeof(text), value, roundTrip));
 }
 
 /**
- * Вычисление стандартного отклонения
+ * Буферизованный вывод доходов
+ *
+ * Текст и числа (через to_chars) собираются в большом буфере, который
+ * отдаётся потоку одной записью, когда заполнится, и при flush/разрушении.
+ */
+class IncomeWriter {
+private:
+    std::ostream& out_;
+    bool roundTrip_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+
+    void reserve(size_t size) {
+        if (buffer_.size() - used_ < size) {
+            flush();
+        }
+    }
+
+public:
+    explicit IncomeWriter(std::ostream& out, bool roundTrip = false, size_t capacity = size_t(1) << 16)
+        : out_(out), roundTrip_(roundTrip), buffer_(std::max<size_t>(capacity, 64)) {}
+
+    ~IncomeWriter() {
+        flush();
+    }
+
+    IncomeWriter(const IncomeWriter&) = delete;
+    IncomeWriter& operator=(const IncomeWriter&) = delete;
+
+    IncomeWriter& text(const char* data, size_t size) {
+        if (size > buffer_.size()) {
+            flush();
+            out_.write(data, static_cast<std::streamsize>(size));
+            return *this;
+        }
+        reserve(size);
+        std::memcpy(buffer_.data() + used_, data, size);
+        used_ += size;
+        return *this;
+    }
+
+    IncomeWriter& text(const std::string& value) {
+        return text(value.data(), value.size());
+    }
+
+    IncomeWriter& text(const char* value) {
+        return text(value, std::strlen(value));
+    }
+
+    IncomeWriter& number(double value) {
+        reserve(32);
+        char* begin = buffer_.data() + used_;
+        used_ += static_cast<size_t>(formatIncome(begin, begin + 32, value, roundTrip_) - begin);
+        return *this;
+    }
+
+    IncomeWriter& count(uint64_t value) {
+        reserve(24);
+        char* begin = buffer_.data() + used_;
+        used_ += static_cast<size_t>(std::to_chars(begin, begin + 24, value).ptr - begin);
+        return *this;
+    }
+
+    void flush() {
+        if (used_ > 0) {
+            out_.write(buffer_.data(), static_cast<std::streamsize>(used_));
+            used_ = 0;
+        }
+        out_.flush();
+    }
+};
+
+/**
+ * Режим вывода массивов: весь массив, начало, конец, начало и конец,
+ * равномерная выборка; Auto - весь массив, если он не длиннее
+ * PRINT_AUTO_LIMIT, иначе начало и конец
+ */
+enum class PrintMode { Auto, All, Head, Tail, Edges, Sample };
+
+const size_t PRINT_AUTO_LIMIT = 1000;
+
+struct PrintOptions {
+    PrintMode mode = PrintMode::Auto;
+    size_t count = 10;      // Сколько элементов выводить в сокращённых режимах
+    bool roundTrip = false; // Кратчайшая точная запись вместо 6 значащих цифр
+};
+
+/**
+ * Вывод массива на экран
  *
  * @param arr указатель на массив.
  * @param N размер массива.
- * @param average среднее значение массива.
- * @return возвращает стандартное отклонение.
+ * @param title заголовок для вывода.
+ * @param print режим и точность вывода.
  */
-double calculateStandardDeviation(double* arr, int N, double average) {
-    double variance = 0.0;
-    for (int i = 0; i < N; i++) {
-        variance += pow((arr[i] - average), 2);
+void printArray(const double* arr, size_t N, const std::string& title, const PrintOptions& print = PrintOptions()) {
+    IncomeWriter writer(std::cout, print.roundTrip);
+    writer.text(title).text(": ");
+
+    PrintMode mode = print.mode;
+    if (mode == PrintMode::Auto) {
+        mode = N <= PRINT_AUTO_LIMIT ? PrintMode::All : PrintMode::Edges;
+    }
+    size_t count = std::min(print.count, N);
+
+    auto values = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            writer.number(arr[i]).text(" ", 1);
+        }
+    };
+    auto skipped = [&](size_t omitted) {
+        if (omitted > 0) {
+            writer.text("... (").count(omitted).text(" more) ");
+        }
+    };
+
+    switch (mode) {
+    case PrintMode::Head:
+        values(0, count);
+        skipped(N - count);
+        break;
+    case PrintMode::Tail:
+        skipped(N - count);
+        values(N - count, N);
+        break;
+    case PrintMode::Edges:
+        if (2 * count >= N) {
+            values(0, N);
+        }
+        else {
+            values(0, count);
+            skipped(N - 2 * count);
+            values(N - count, N);
+        }
+        break;
+    case PrintMode::Sample:
+        // count значений с равным шагом, каждое с номером месяца
+        for (size_t k = 0; k < count; k++) {
+            size_t i = count > 1 ? static_cast<size_t>(static_cast<double>(k) * (N - 1) / (count - 1)) : 0;
+            writer.text("#", 1).count(i + 1).text(":", 1).number(arr[i]).text(" ", 1);
+        }
+        break;
+    default:
+        values(0, N);
     }
-    variance /= N;
-    return sqrt(variance);
+    writer.text("\n", 1);
 }
 
 /**
- * Сортировка массива по возрастанию (передача по указателю)
+ * Операция пакетного режима: имя и необязательный аргумент ("rolling=12")
+ */
+struct BatchOperation {
+    std::string name;
+    std::string argument;
+};
+
+/**
+ * Разбор списка операций пакетного режима
  *
- * @param arr указатель на массив.
- * @param N размер массива.
+ * Операции: extremes, stats, sort[=FILE], quantiles, sketch, rolling=K.
+ *
+ * @param list операции через запятую.
+ * @return возвращает операции в порядке выполнения.
  */
-void sortArrayPointer(double* arr, int N) {
-    std::sort(arr, arr + N);
+std::vector<BatchOperation> parseBatchOperations(const std::string& list) {
+    std::vector<BatchOperation> operations;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        std::string item = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        start = comma == std::string::npos ? list.size() + 1 : comma + 1;
+
+        BatchOperation operation;
+        size_t equals = item.find('=');
+        operation.name = item.substr(0, equals);
+        if (equals != std::string::npos) {
+            operation.argument = item.substr(equals + 1);
+        }
+
+        bool known = operation.name == "extremes" || operation.name == "stats" || operation.name == "sort"
+            || operation.name == "quantiles" || operation.name == "sketch" || operation.name == "rolling";
+        if (!known) {
+            throw std::invalid_argument("Error: unknown batch operation '" + item + "'.");
+        }
+        if (operation.name == "rolling" && std::atoll(operation.argument.c_str()) <= 0) {
+            throw std::invalid_argument("Error: rolling requires a positive window, e.g. rolling=12.");
+        }
+        operations.push_back(operation);
+    }
+    return operations;
 }
 
 /**
- * Создание отсортированной копии массива (передача по значению)
+ * Пиковый объём резидентной памяти процесса в килобайтах
  *
- * @param arr копия массива.
- * @param N размер массива.
- * @return возвращает отсортированную копию массива.
+ * Пик считается за всё время работы процесса, поэтому для каждой операции
+ * это максимум с начала запуска по её окончании.
  */
-double* sortArrayValue(double arr[], int N) {
-    double* sortedArr = new double[N];
-    // Копируем данные из исходного массива
-    for (int i = 0; i < N; i++) {
-        sortedArr[i] = arr[i];
+uint64_t peakResidentKilobytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<uint64_t>(counters.PeakWorkingSetSize) / 1024;
     }
-    // Сортируем копию массива
-    std::sort(sortedArr, sortedArr + N);
-    return sortedArr; // Возвращаем указатель на отсортированную копию
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024; // macOS сообщает байты
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
 }
 
 /**
- * Вывод массива на экран
+ * Вывод строки отчёта пакетного режима (CSV)
+ */
+void writeBatchRow(std::ostream& out, const std::string& operation, size_t elements, double seconds,
+    const std::string& result) {
+    char line[256];
+    double rate = seconds > 0.0 ? elements / seconds : 0.0;
+    snprintf(line, sizeof(line), "%s,%zu,%.9f,%.1f,%.2f,%llu,", operation.c_str(), elements, seconds,
+        rate, rate * sizeof(double) / 1e6, static_cast<unsigned long long>(peakResidentKilobytes()));
+    out << line << result << "\n";
+    out.flush();
+}
+
+/**
+ * Выполнение операций пакетного режима с замером времени каждой
  *
- * @param arr указатель на массив.
- * @param N размер массива.
- * @param title заголовок для вывода.
+ * Результаты выводятся в CSV: operation, elements, seconds, elements_per_s,
+ * mb_per_s, peak_rss_kb, result; поле result - пары key=value через ';'
+ * (доходы - в кратчайшей точной записи).
+ *
+ * @param income набор доходов.
+ * @param operations операции в порядке выполнения.
+ * @param threads количество потоков.
+ * @param out поток отчёта.
  */
-void printArray(double* arr, int N, const std::string& title) {
-    std::cout << title << ": ";
-    for (int i = 0; i < N; i++) {
-        std::cout << arr[i] << " ";
+void runBatch(IncomeData& income, const std::vector<BatchOperation>& operations, unsigned threads,
+    std::ostream& out) {
+    size_t N = income.size();
+    for (const BatchOperation& operation : operations) {
+        char result[256];
+        auto start = std::chrono::steady_clock::now();
+
+        if (operation.name == "extremes") {
+            ExtremesResult extremes = findExtremes(income, threads);
+            snprintf(result, sizeof(result), "max_month=%zu;min_month=%zu",
+                N ? extremes.maxIndex + 1 : 0, N ? extremes.minIndex + 1 : 0);
+        }
+        else if (operation.name == "stats") {
+            IncomeStats stats = computeIncomeStats(income, threads);
+            snprintf(result, sizeof(result), "mean=%s;std_dev=%s", formatIncome(stats.mean, true).c_str(),
+                formatIncome(stats.standardDeviation(), true).c_str());
+        }
+        else if (operation.name == "sort") {
+            if (!operation.argument.empty()) {
+                sortIncomeToFile(income, operation.argument, income.sorter());
+                snprintf(result, sizeof(result), "output=%s", operation.argument.c_str());
+            }
+            else if (income.mapped()) {
+                throw std::invalid_argument("Error: sorting a file dataset requires sort=FILE.");
+            }
+            else {
+                const std::vector<double>& sorted = income.sorted();
+                snprintf(result, sizeof(result), "first=%s;last=%s",
+                    formatIncome(N ? sorted.front() : 0.0, true).c_str(), formatIncome(N ? sorted.back() : 0.0, true).c_str());
+            }
+        }
+        else if (operation.name == "quantiles" || operation.name == "sketch") {
+            const std::vector<double> fractions = { 0.5, 0.9, 0.99 };
+            std::vector<double> values;
+            if (operation.name == "sketch" || income.mapped()) {
+                values = buildQuantileSketch(income, threads).quantiles(fractions);
+            }
+            else {
+                std::vector<double> scratch;
+                values = exactQuantiles(income.data(), N, fractions, scratch);
+            }
+            snprintf(result, sizeof(result), "p50=%s;p90=%s;p99=%s", formatIncome(values[0], true).c_str(),
+                formatIncome(values[1], true).c_str(), formatIncome(values[2], true).c_str());
+        }
+        else {
+            size_t window = static_cast<size_t>(std::atoll(operation.argument.c_str()));
+            RollingWindow rolling(window);
+            size_t points = 0;
+            double volatility = 0.0;
+            income.forEachChunk([&](const double* chunk, size_t, size_t count) {
+                for (size_t i = 0; i < count; i++) {
+                    rolling.push(chunk[i]);
+                    if (rolling.full()) {
+                        points++;
+                        volatility = std::max(volatility, rolling.current().standardDeviation);
+                    }
+                }
+            });
+            snprintf(result, sizeof(result), "windows=%zu;max_std_dev=%s", points, formatIncome(volatility, true).c_str());
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::string name = operation.argument.empty() ? operation.name : operation.name + "=" + operation.argument;
+        writeBatchRow(out, name, N, seconds, result);
     }
-    std::cout << std::endl;
 }
 
-int main() {
-    srand(time(0));
+/**
+ * Параметры запуска анализатора доходов
+ */
+struct IncomeOptions {
+    uint64_t seed = static_cast<uint64_t>(time(0)); // Ключ генератора данных
+    unsigned threads = defaultThreadCount();         // Количество рабочих потоков
+    std::string input;                               // Двоичный файл доходов (вместо генерации)
+    std::string saveBinary;                          // Куда сохранить данные в двоичном виде
+    size_t months = 0;                               // Размер генерируемого ряда (0 - спросить)
+    std::string batch;                               // Операции пакетного режима через запятую
+    PrintOptions print;                              // Режим и точность вывода массивов
+};
+
+/**
+ * Разбор аргументов командной строки
+ *
+ * Поддерживается: --seed S, --threads N, --input FILE, --save-binary FILE,
+ * --months N, --batch OPS, --print auto|all|head|tail|edges|sample,
+ * --print-count K, --round-trip
+ *
+ * @param argc количество аргументов.
+ * @param argv массив аргументов.
+ * @return возвращает параметры запуска.
+ */
+IncomeOptions parseOptions(int argc, char* argv[]) {
+    IncomeOptions options;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seed") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Error: --seed requires a value.");
+            }
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--threads") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Error: --threads requires a value.");
+            }
+            int value = std::atoi(argv[++i]);
+            if (value <= 0) {
+                throw std::invalid_argument("Error: --threads must be a positive number.");
+            }
+            options.threads = static_cast<unsigned>(value);
+        }
+        else if (arg == "--input") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Error: --input requires a file path.");
+            }
+            options.input = argv[++i];
+        }
+        else if (arg == "--save-binary") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Error: --save-binary requires a file path.");
+            }
+            options.saveBinary = argv[++i];
+        }
+        else if (arg == "--months") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Error: --months requires a value.");
+            }
+            long long value = std::atoll(argv[++i]);
+            if (value <= 0) {
+                throw std::invalid_argument("Error: --months must be a positive number.");
+            }
+            options.months = static_cast<size_t>(value);
+        }
+        else if (arg == "--batch") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Error: --batch requires a list of operations.");
+            }
+            options.batch = argv[++i];
+        }
+        else if (arg == "--print") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Error: --print requires a mode.");
+            }
+            std::string mode = argv[++i];
+            if (mode == "auto") options.print.mode = PrintMode::Auto;
+            else if (mode == "all") options.print.mode = PrintMode::All;
+            else if (mode == "head") options.print.mode = PrintMode::Head;
+            else if (mode == "tail") options.print.mode = PrintMode::Tail;
+            else if (mode == "edges") options.print.mode = PrintMode::Edges;
+            else if (mode == "sample") options.print.mode = PrintMode::Sample;
+            else {
+                throw std::invalid_argument("Error: unknown print mode '" + mode + "'.");
+            }
+        }
+        else if (arg == "--print-count") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Error: --print-count requires a value.");
+            }
+            long long value = std::atoll(argv[++i]);
+            if (value <= 0) {
+                throw std::invalid_argument("Error: --print-count must be a positive number.");
+            }
+            options.print.count = static_cast<size_t>(value);
+        }
+        else if (arg == "--round-trip") {
+            options.print.roundTrip = true;
+        }
+        else {
+            throw std::invalid_argument("Error: unknown argument '" + arg + "'.");
+        }
+    }
+
+    if (!options.input.empty() && options.months != 0) {
+        throw std::invalid_argument("Error: --months cannot be combined with --input.");
+    }
+    if (!options.batch.empty() && options.input.empty() && options.months == 0) {
+        throw std::invalid_argument("Error: --batch requires --input or --months.");
+    }
 
-    int N;
-    std::cout << "Enter the number of months (N): ";
-    std::cin >> N;
+    return options;
+}
 
-    double* income = new double[N];
+int main(int argc, char* argv[]) {
+    IncomeOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
-    fillArray(income, N, 10.0, 100.0);
+    // Данные либо отображаются из двоичного файла, либо генерируются
+    bool batch = !options.batch.empty();
+    std::vector<BatchOperation> operations;
+    std::unique_ptr<IncomeData> dataset;
+    try {
+        if (batch) {
+            operations = parseBatchOperations(options.batch);
+            std::cout << "operation,elements,seconds,elements_per_s,mb_per_s,peak_rss_kb,result\n";
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (!options.input.empty()) {
+            dataset.reset(new IncomeData(options.input, options.threads));
+        }
+        else {
+            size_t months = options.months;
+            if (months == 0) {
+                std::cout << "Enter the number of months (N): ";
+                std::cin >> months;
+            }
+            dataset.reset(new IncomeData(months, options.threads));
+            dataset->fill(10.0, 100.0, options.seed, options.threads);
+        }
+        if (batch) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            writeBatchRow(std::cout, options.input.empty() ? "generate" : "open", dataset->size(), seconds, "");
+        }
+        if (!options.saveBinary.empty()) {
+            saveIncomeBinary(options.saveBinary, dataset->data(), dataset->size());
+        }
+        if (batch) {
+            runBatch(*dataset, operations, options.threads, std::cout);
+            return 0;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    IncomeData& income = *dataset;
+    size_t N = income.size();
 
-    std::cout << "\nInitial data:" << std::endl;
-    printArray(income, N, "Monthly income");
+    if (income.mapped()) {
+        std::cout << "\nLoaded " << N << " months from '" << options.input << "'." << std::endl;
+    }
+    else {
+        std::cout << "\nInitial data:" << std::endl;
+        printArray(income.data(), N, "Monthly income", options.print);
+    }
 
     int choice;
     do {
@@ -135,6 +2100,8 @@ int main() {
         std::cout << "2. Calculate average annual income and standard deviation" << std::endl;
         std::cout << "3. Sort array in ascending order" << std::endl;
         std::cout << "4. Compare pass by value and pass by reference" << std::endl;
+        std::cout << "5. Income percentiles (median, p90, p99)" << std::endl;
+        std::cout << "6. Rolling statistics over a k-month window" << std::endl;
         std::cout << "0. Exit" << std::endl;
         std::cout << "Your choice: ";
         std::cin >> choice;
@@ -142,58 +2109,67 @@ int main() {
         switch (choice) {
         case 1: {
             // Поиск месяцев с максимальным и минимальным доходом
-            int maxMonth, minMonth;
-            findExtremes(income, N, maxMonth, minMonth);
-            std::cout << "Maximum income: month " << maxMonth + 1
-                << " (" << income[maxMonth] << ")" << std::endl;
-            std::cout << "Minimum income: month " << minMonth + 1
-                << " (" << income[minMonth] << ")" << std::endl;
+            if (N == 0) {
+                std::cout << "No data." << std::endl;
+                break;
+            }
+            ExtremesResult extremes = findExtremes(income, options.threads);
+            IncomeWriter writer(std::cout, options.print.roundTrip);
+            writer.text("Maximum income: month ").count(extremes.maxIndex + 1)
+                .text(" (").number(income[extremes.maxIndex]).text(")\n");
+            writer.text("Minimum income: month ").count(extremes.minIndex + 1)
+                .text(" (").number(income[extremes.minIndex]).text(")\n");
             break;
         }
 
         case 2: {
-            // Вычисление статистических показателей
-            double average = calculateAverage(income, N);
-            double deviation = calculateStandardDeviation(income, N, average);
-            std::cout << "Average annual income: " << average << std::endl;
-            std::cout << "Standard deviation: " << deviation << std::endl;
+            // Вычисление статистических показателей за один проход
+            IncomeStats stats = computeIncomeStats(income, options.threads);
+            IncomeWriter writer(std::cout, options.print.roundTrip);
+            writer.text("Average annual income: ").number(stats.mean).text("\n");
+            writer.text("Standard deviation: ").number(stats.standardDeviation()).text("\n");
             break;
         }
 
         case 3: {
-            // Создание копии массива для демонстрации сортировки
-            double* incomeCopy = new double[N];
-            for (int i = 0; i < N; i++) {
-                incomeCopy[i] = income[i];
+            if (income.mapped()) {
+                // Ряд из файла может не поместиться в память - сортируем внешне в файл
+                std::string path;
+                std::cout << "Enter the output file for the sorted series: ";
+                std::cin >> path;
+                try {
+                    sortIncomeToFile(income, path, income.sorter());
+                    std::cout << "Sorted series written to '" << path << "'." << std::endl;
+                }
+                catch (const std::exception& e) {
+                    std::cout << e.what() << std::endl;
+                }
+                break;
             }
-
-            sortArrayPointer(incomeCopy, N);
-            printArray(incomeCopy, N, "Sorted array");
-            delete[] incomeCopy;
+            // Отсортированное представление строится один раз и переиспользуется
+            printArray(income.sorted().data(), N, "Sorted array", options.print);
             break;
         }
 
         case 4: {
+            if (income.mapped()) {
+                std::cout << "This demonstration needs the series in memory." << std::endl;
+                break;
+            }
             // Демонстрация разницы между передачей по указателю и по значению
             std::cout << "\nComparison of pass by value and pass by reference:" << std::endl;
 
-            double* arr1 = new double[N];
-            for (int i = 0; i < N; i++) arr1[i] = income[i];
-
-            std::cout << "Before sorting (pass by pointer): ";
-            printArray(arr1, N, "");
-            sortArrayPointer(arr1, N);
-            std::cout << "After sorting (pass by pointer): ";
-            printArray(arr1, N, "");
-            delete[] arr1;
-
-            std::cout << "Original array before pass by value: ";
-            printArray(income, N, "");
-            double* sortedArr = sortArrayValue(income, N);
-            std::cout << "Sorted copy (pass by value): ";
-            printArray(sortedArr, N, "");
-            std::cout << "Original array after pass by value: ";
-            printArray(income, N, "");
+            // Сортировка на месте показывается на рабочей копии
+            std::vector<double> arr1(income.data(), income.data() + N);
+
+            printArray(arr1.data(), N, "Before sorting (pass by pointer)", options.print);
+            sortArrayPointer(arr1.data(), N, income.sorter());
+            printArray(arr1.data(), N, "After sorting (pass by pointer)", options.print);
+
+            printArray(income.data(), N, "Original array before pass by value", options.print);
+            double* sortedArr = sortArrayValue(income.data(), N, income.sorter());
+            printArray(sortedArr, N, "Sorted copy (pass by value)", options.print);
+            printArray(income.data(), N, "Original array after pass by value", options.print);
             delete[] sortedArr;
 
             std::cout << "\nConclusion: pass by pointer/reference modifies the original array, ";
@@ -201,6 +2177,59 @@ int main() {
             break;
         }
 
+        case 5: {
+            // Точные квантили выбором и приближённые по скетчу
+            const std::vector<double> fractions = { 0.5, 0.9, 0.99 };
+            const char* names[] = { "Median", "p90", "p99" };
+            std::vector<double> approx = buildQuantileSketch(income, options.threads).quantiles(fractions);
+            IncomeWriter writer(std::cout, options.print.roundTrip);
+            if (income.mapped()) {
+                // Точный выбор требует копии ряда в памяти - для файла только оценка
+                for (size_t i = 0; i < fractions.size(); i++) {
+                    writer.text(names[i]).text(" (sketch estimate): ").number(approx[i]).text("\n");
+                }
+                break;
+            }
+            std::vector<double> scratch;
+            std::vector<double> exact = exactQuantiles(income.data(), N, fractions, scratch);
+            for (size_t i = 0; i < fractions.size(); i++) {
+                writer.text(names[i]).text(": ").number(exact[i])
+                    .text(" (sketch estimate: ").number(approx[i]).text(")\n");
+            }
+            break;
+        }
+
+        case 6: {
+            // Скользящие среднее, отклонение и экстремумы за один проход
+            size_t window;
+            std::cout << "Enter the window length in months: ";
+            std::cin >> window;
+            if (!std::cin || window == 0 || window > N) {
+                std::cin.clear();
+                std::cout << "Window length must be between 1 and " << N << "." << std::endl;
+                break;
+            }
+            // Окно идёт по ряду участками, точки выводятся по мере готовности
+            RollingWindow rolling(window);
+            IncomeWriter writer(std::cout, options.print.roundTrip);
+            income.forEachChunk([&](const double* chunk, size_t offset, size_t count) {
+                for (size_t i = 0; i < count; i++) {
+                    rolling.push(chunk[i]);
+                    if (!rolling.full()) {
+                        continue;
+                    }
+                    RollingPoint point = rolling.current();
+                    size_t last = offset + i + 1;
+                    writer.text("Months ").count(last - window + 1).text("-").count(last)
+                        .text(": mean ").number(point.mean)
+                        .text(", std dev ").number(point.standardDeviation)
+                        .text(", min ").number(point.min)
+                        .text(", max ").number(point.max).text("\n");
+                }
+            });
+            break;
+        }
+
         case 0:
             std::cout << "Exiting program." << std::endl;
             break;
@@ -210,8 +2239,5 @@ int main() {
         }
     } while (choice != 0);
 
-    // Освобождение памяти, выделенной для основного массива
-    delete[] income;
-
     return 0;
 }
\ No newline at end of file